@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "alloc.h"
+
+static std::atomic<uint64_t> _m_allocations[static_cast<size_t>(RoPP::AllocTag::Count)];
+static std::atomic<uint64_t> _m_bytes[static_cast<size_t>(RoPP::AllocTag::Count)];
+static thread_local uint64_t _m_threadAllocations = 0;
+static thread_local uint64_t _m_threadBytes = 0;
+
+const char* RoPP::AllocTagName(AllocTag Tag)
+{
+    switch (Tag)
+    {
+    case AllocTag::Transport: return "transport";
+    case AllocTag::Headers: return "headers";
+    case AllocTag::Json: return "json";
+    case AllocTag::Cache: return "cache";
+    default: return "other";
+    }
+}
+
+/*
+* @brief gets the process wide allocation counters per subsystem
+* @return counters indexed by AllocTag
+*/
+RoPP::AllocStats RoPP::GetAllocStats()
+{
+    AllocStats stats;
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        stats[i].Allocations = _m_allocations[i].load(std::memory_order_relaxed);
+        stats[i].Bytes = _m_bytes[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void RoPP::ResetAllocStats()
+{
+    for (size_t i = 0; i < static_cast<size_t>(AllocTag::Count); i++)
+    {
+        _m_allocations[i] = 0;
+        _m_bytes[i] = 0;
+    }
+}
+
+/*
+* @brief renders the counters in the prometheus text exposition format
+* @return ropp_allocations_total and ropp_allocated_bytes_total per subsystem
+*/
+std::string RoPP::AllocReport()
+{
+    AllocStats stats = GetAllocStats();
+    std::ostringstream out;
+    out << "# TYPE ropp_allocations_total counter\n";
+    for (size_t i = 0; i < stats.size(); i++)
+        out << "ropp_allocations_total{subsystem=\"" << AllocTagName(static_cast<AllocTag>(i)) << "\"} " << stats[i].Allocations << "\n";
+    out << "# TYPE ropp_allocated_bytes_total counter\n";
+    for (size_t i = 0; i < stats.size(); i++)
+        out << "ropp_allocated_bytes_total{subsystem=\"" << AllocTagName(static_cast<AllocTag>(i)) << "\"} " << stats[i].Bytes << "\n";
+    return out.str();
+}
+
+/*
+* @brief gets the allocations made by the calling thread since it started
+* @return thread allocation counters
+*/
+RoPP::AllocCounters RoPP::ThreadAllocations()
+{
+    return { _m_threadAllocations, _m_threadBytes };
+}
+
+#ifdef ROPP_ALLOC_ACCOUNTING
+static thread_local RoPP::AllocTag _m_tag = RoPP::AllocTag::Other;
+
+RoPP::AllocScope::AllocScope(AllocTag Tag) : Saved(_m_tag)
+{
+    _m_tag = Tag;
+}
+
+RoPP::AllocScope::~AllocScope()
+{
+    _m_tag = this->Saved;
+}
+
+static void* _m_allocate(std::size_t size, std::size_t alignment, bool nothrow)
+{
+    size_t tag = static_cast<size_t>(_m_tag);
+    _m_allocations[tag].fetch_add(1, std::memory_order_relaxed);
+    _m_bytes[tag].fetch_add(size, std::memory_order_relaxed);
+    _m_threadAllocations++;
+    _m_threadBytes += size;
+
+    if (size == 0)
+        size = 1;
+    void* ptr = nullptr;
+    if (alignment <= alignof(std::max_align_t))
+        ptr = std::malloc(size);
+    else if (posix_memalign(&ptr, alignment, size) != 0)
+        ptr = nullptr;
+
+    if (!ptr && !nothrow)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(std::size_t size) { return _m_allocate(size, 0, false); }
+void* operator new[](std::size_t size) { return _m_allocate(size, 0, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return _m_allocate(size, 0, true); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return _m_allocate(size, 0, true); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return _m_allocate(size, static_cast<size_t>(alignment), false); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return _m_allocate(size, static_cast<size_t>(alignment), false); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return _m_allocate(size, static_cast<size_t>(alignment), true); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return _m_allocate(size, static_cast<size_t>(alignment), true); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+/*
+* Allocation accounting, compiled in with ROPP_ALLOC_ACCOUNTING. The global operator new is
+* replaced by a counting one that charges every allocation to the subsystem tag of the
+* innermost ROPP_ALLOC_SCOPE on the allocating thread. Without the flag scopes compile away
+* and the counters stay zero.
+*/
+
+namespace RoPP
+{
+    enum class AllocTag : uint8_t { Other, Transport, Headers, Json, Cache, Count };
+
+    struct AllocCounters
+    {
+        uint64_t Allocations = 0;
+        uint64_t Bytes = 0;
+    };
+
+    using AllocStats = std::array<AllocCounters, static_cast<size_t>(AllocTag::Count)>;
+
+    const char* AllocTagName(AllocTag Tag);
+    AllocStats GetAllocStats();
+    void ResetAllocStats();
+    std::string AllocReport();
+    AllocCounters ThreadAllocations();
+
+#ifdef ROPP_ALLOC_ACCOUNTING
+    class AllocScope
+    {
+        public:
+            explicit AllocScope(AllocTag Tag);
+            ~AllocScope();
+
+        private:
+            AllocTag Saved;
+    };
+#endif
+}
+
+#ifdef ROPP_ALLOC_ACCOUNTING
+#define ROPP_ALLOC_SCOPE(tag) RoPP::AllocScope _m_allocScope(RoPP::AllocTag::tag)
+#elif !defined(ROPP_ALLOC_SCOPE)
+#define ROPP_ALLOC_SCOPE(tag) do {} while (0)
+#endif
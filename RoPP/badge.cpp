@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "json.h"
+#include "parallel.h"
+#include "ropp.h"
+
+static std::string _m_awardKey(long UserId, long BadgeId)
+{
+    return "ropp:badge:" + std::to_string(UserId) + ":" + std::to_string(BadgeId);
+}
+
+/*
+* Cached answers are "1" followed by the award date, or "0" for a badge not awarded, so
+* an award whose date came back empty still reads back as awarded.
+*/
+static std::string _m_encode(const RoPP::BadgeAward& Award)
+{
+    return Award.Awarded ? "1" + Award.AwardedDate : "0";
+}
+
+static bool _m_decode(const std::string& Value, RoPP::BadgeAward& Award)
+{
+    if (Value.empty() || (Value[0] != '1' && Value[0] != '0'))
+        return false;
+    Award.Awarded = Value[0] == '1';
+    Award.AwardedDate = Value.substr(1);
+    return true;
+}
+
+namespace
+{
+    // one awarded-dates request: up to Badge::BatchLimit of one user's uncached badges
+    struct _m_Batch
+    {
+        size_t Query = 0;
+        std::vector<long> BadgeIds;
+        bool Answered = false;
+        std::unordered_map<long, std::string> Awarded; // badge id to award date
+    };
+}
+
+/*
+* @brief asks awarded-dates about one batch, leaving it unanswered when the request or its body fails
+*/
+static void _m_fetchBatch(long UserId, _m_Batch& Batch)
+{
+    std::string url = "https://badges.roblox.com/v1/users/" + std::to_string(UserId) + "/badges/awarded-dates?badgeIds=";
+    for (size_t i = 0; i < Batch.BadgeIds.size(); i++)
+        url += (i ? "," : "") + std::to_string(Batch.BadgeIds[i]);
+
+    try
+    {
+        json body = RoPP::FetchJson(url, nullptr, RoPP::Endpoint::BadgeAwards);
+        if (!body.is_object() || !body.contains("data") || !body["data"].is_array())
+            return;
+
+        for (const json& item : body["data"])
+        {
+            if (!item.is_object() || !item.contains("badgeId") || !item["badgeId"].is_number_integer())
+                continue;
+            const json& date = item.contains("awardedDate") ? item["awardedDate"] : json();
+            Batch.Awarded[item["badgeId"].get<long>()] = date.is_string() ? date.get<std::string>() : "";
+        }
+        Batch.Answered = true;
+    }
+    catch (const json::exception&)
+    {
+        Batch.Awarded.clear();
+    }
+}
+
+/*
+* @brief checks badge awards for many users, see badge.h; the cache is only used from the calling
+* thread, the workers just make the requests
+* @param Concurrency requests in flight at once
+* @return one award per distinct (user, badge) pair resolved
+*/
+std::vector<RoPP::BadgeAward> RoPP::Badge::CheckAwards(const std::vector<BadgeQuery>& Queries, Cache* CacheLayer, size_t Concurrency, std::chrono::seconds NegativeTtl)
+{
+    std::vector<std::unordered_map<long, BadgeAward>> known(Queries.size());
+    std::vector<_m_Batch> batches;
+    for (size_t q = 0; q < Queries.size(); q++)
+    {
+        long user = Queries[q].UserId;
+        std::unordered_set<long> seen;
+        std::vector<long> missing;
+        for (long badge : Queries[q].BadgeIds)
+        {
+            if (!seen.insert(badge).second)
+                continue;
+
+            BadgeAward award{ user, badge, false, "" };
+            std::string value;
+            if (CacheLayer && CacheLayer->Get(_m_awardKey(user, badge), value) && _m_decode(value, award))
+                known[q][badge] = award;
+            else
+                missing.push_back(badge);
+        }
+
+        for (size_t begin = 0; begin < missing.size(); begin += BatchLimit)
+        {
+            size_t end = std::min(missing.size(), begin + BatchLimit);
+            _m_Batch batch;
+            batch.Query = q;
+            batch.BadgeIds.assign(missing.begin() + begin, missing.begin() + end);
+            batches.push_back(std::move(batch));
+        }
+    }
+
+    ParallelFor(batches.size(), Concurrency, [&](size_t i, size_t)
+    {
+        _m_fetchBatch(Queries[batches[i].Query].UserId, batches[i]);
+    });
+
+    for (const _m_Batch& batch : batches)
+    {
+        if (!batch.Answered)
+            continue;
+
+        long user = Queries[batch.Query].UserId;
+        for (long badge : batch.BadgeIds)
+        {
+            auto date = batch.Awarded.find(badge);
+            BadgeAward award{ user, badge, date != batch.Awarded.end(), date != batch.Awarded.end() ? date->second : "" };
+            known[batch.Query][badge] = award;
+            if (CacheLayer)
+                CacheLayer->Put(_m_awardKey(user, badge), _m_encode(award), award.Awarded ? Cache::Forever : NegativeTtl);
+        }
+    }
+
+    std::vector<BadgeAward> awards;
+    for (size_t q = 0; q < Queries.size(); q++)
+    {
+        std::unordered_set<long> seen;
+        for (long badge : Queries[q].BadgeIds)
+        {
+            auto it = known[q].find(badge);
+            if (it != known[q].end() && seen.insert(badge).second)
+                awards.push_back(it->second);
+        }
+    }
+    return awards;
+}
+
+/*
+* @brief checks the same badges for every user, see badge.h
+*/
+std::vector<RoPP::BadgeAward> RoPP::Badge::CheckAwards(const std::vector<long>& UserIds, const std::vector<long>& BadgeIds, Cache* CacheLayer, size_t Concurrency, std::chrono::seconds NegativeTtl)
+{
+    std::vector<BadgeQuery> queries;
+    queries.reserve(UserIds.size());
+    for (long user : UserIds)
+        queries.push_back({ user, BadgeIds });
+    return CheckAwards(queries, CacheLayer, Concurrency, NegativeTtl);
+}
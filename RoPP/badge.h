@@ -0,0 +1,44 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+
+namespace RoPP
+{
+    struct BadgeAward
+    {
+        long UserId = 0;
+        long BadgeId = 0;
+        bool Awarded = false;
+        std::string AwardedDate; // ISO 8601, empty when not awarded
+    };
+
+    struct BadgeQuery
+    {
+        long UserId;
+        std::vector<long> BadgeIds;
+    };
+
+    class Badge
+    {
+        public:
+            // badge ids per awarded-dates request
+            static constexpr size_t BatchLimit = 100;
+
+            /*
+            * Checks which of their badges each user has been awarded. Every user's badge ids go
+            * out in as few awarded-dates requests as the batch limit allows, Concurrency of them
+            * in flight at once. With a cache layer an award is remembered forever, since badges
+            * are never taken back, and a missing award for NegativeTtl. The cache is only used
+            * from the calling thread.
+            * Returns one entry per distinct (user, badge) pair, in query order. Pairs whose
+            * request failed are left out, so a missing pair means unknown, not unawarded.
+            */
+            static std::vector<BadgeAward> CheckAwards(const std::vector<BadgeQuery>& Queries, Cache* CacheLayer = nullptr,
+                size_t Concurrency = 8, std::chrono::seconds NegativeTtl = std::chrono::seconds(300));
+            static std::vector<BadgeAward> CheckAwards(const std::vector<long>& UserIds, const std::vector<long>& BadgeIds,
+                Cache* CacheLayer = nullptr, size_t Concurrency = 8, std::chrono::seconds NegativeTtl = std::chrono::seconds(300));
+    };
+}
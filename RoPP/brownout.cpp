@@ -0,0 +1,121 @@
+#include "brownout.h"
+#include "log.h"
+#include "trace.h"
+
+static std::atomic<RoPP::Brownout*> _m_current{ nullptr };
+
+RoPP::Brownout::Brownout(BrownoutPolicy Policy, std::initializer_list<Endpoint> Endpoints) : Policy(Policy)
+{
+    for (Endpoint id : Endpoints)
+        this->Selected[static_cast<size_t>(id)] = true;
+}
+
+/*
+* @brief checks whether calls to an endpoint should be answered from the cache
+*/
+bool RoPP::Brownout::Degraded(Endpoint Id) const
+{
+    return this->Active.load(std::memory_order_relaxed) && this->Selected[static_cast<size_t>(Id)];
+}
+
+/*
+* @brief claims the next upstream probe slot while degraded
+* @return true for at most one caller per probe interval
+*/
+bool RoPP::Brownout::TryProbe()
+{
+    uint64_t now = Tracer::Now();
+    uint64_t next = this->NextProbe.load(std::memory_order_relaxed);
+    if (now < next)
+        return false;
+
+    uint64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(this->Policy.ProbeInterval).count();
+    if (!this->NextProbe.compare_exchange_strong(next, now + interval))
+        return false;
+    this->Probes++;
+    return true;
+}
+
+/*
+* @brief feeds one upstream result into the window and switches the brownout on or off
+* @param Latency nanoseconds the upstream request took
+*/
+void RoPP::Brownout::Record(bool Healthy, uint64_t Latency)
+{
+    uint64_t now = Tracer::Now();
+    uint64_t width = std::chrono::duration_cast<std::chrono::nanoseconds>(this->Policy.Window).count() / Buckets;
+    uint64_t epoch = now / (width ? width : 1);
+    uint64_t limit = std::chrono::duration_cast<std::chrono::nanoseconds>(this->Policy.Latency).count();
+    bool good = Healthy && Latency <= limit;
+
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (this->Active)
+    {
+        // degraded: only a run of healthy results ends it
+        this->HealthyRun = good ? this->HealthyRun + 1 : 0;
+        if (this->HealthyRun >= this->Policy.RecoverAfter)
+        {
+            this->Active = false;
+            this->HealthyRun = 0;
+            this->Window.fill(Bucket());
+            ROPP_LOG(LogLevel::Warn, LogEvent::BrownoutEnd, Endpoint::Unknown, 0, 0, Latency);
+        }
+        return;
+    }
+
+    Bucket& bucket = this->Window[epoch % Buckets];
+    if (bucket.Epoch != epoch)
+        bucket = Bucket{ epoch };
+    bucket.Requests++;
+    bucket.Errors += !Healthy;
+    bucket.Latency += Latency;
+
+    uint64_t requests = 0, errors = 0, latency = 0;
+    for (const Bucket& past : this->Window)
+    {
+        if (past.Epoch + Buckets <= epoch)
+            continue;
+        requests += past.Requests;
+        errors += past.Errors;
+        latency += past.Latency;
+    }
+    if (requests < this->Policy.MinSamples)
+        return;
+
+    if (errors >= this->Policy.ErrorRate * requests || latency / requests >= limit)
+    {
+        this->Active = true;
+        this->HealthyRun = 0;
+        this->Trips++;
+        this->NextProbe = now + std::chrono::duration_cast<std::chrono::nanoseconds>(this->Policy.ProbeInterval).count();
+        ROPP_LOG(LogLevel::Warn, LogEvent::BrownoutStart, Endpoint::Unknown, static_cast<int32_t>(errors), requests, latency / requests);
+    }
+}
+
+void RoPP::Brownout::StaleServed()
+{
+    this->Stale++;
+}
+
+/*
+* @brief gets whether the brownout is on and what it has done so far
+*/
+RoPP::BrownoutStats RoPP::Brownout::Stats()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return { this->Active.load(), this->Trips, this->Stale.load(), this->Probes.load() };
+}
+
+/*
+* @brief installs the brownout controller Fetch consults, nullptr disables it
+* @param Controller must outlive its use
+*/
+void RoPP::SetBrownout(Brownout* Controller)
+{
+    _m_current.store(Controller, std::memory_order_release);
+}
+
+RoPP::Brownout* RoPP::CurrentBrownout()
+{
+    return _m_current.load(std::memory_order_acquire);
+}
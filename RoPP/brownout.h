@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+
+#include "endpoint.h"
+
+namespace RoPP
+{
+    struct BrownoutPolicy
+    {
+        double ErrorRate = 0.25;                        // failed share of upstream requests that trips it
+        std::chrono::milliseconds Latency{ 2000 };      // mean upstream latency that trips it
+        uint32_t MinSamples = 20;                       // requests in the window before either is judged
+        std::chrono::seconds Window{ 10 };
+        std::chrono::seconds MaxStaleness{ 300 };       // oldest expired entry worth serving
+        std::chrono::milliseconds ProbeInterval{ 500 }; // one upstream probe per interval while degraded
+        uint32_t RecoverAfter = 3;                      // consecutive healthy upstream results to recover
+    };
+
+    struct BrownoutStats
+    {
+        bool Degraded = false;
+        uint64_t Trips = 0;
+        uint64_t StaleServed = 0;
+        uint64_t Probes = 0;
+    };
+
+    /*
+    * Watches upstream error rate and latency for Fetch. When either passes its threshold,
+    * the selected endpoints stop going upstream on a cache miss. Fetch serves them from the
+    * cache instead, expired entries included up to MaxStaleness. One request per
+    * ProbeInterval is still let through as a probe. RecoverAfter healthy results in a row
+    * end the brownout. Endpoints that are not selected, or misses with nothing stale to
+    * serve, always go upstream.
+    *   RoPP::Brownout brownout(policy, { Endpoint::UserInfo, Endpoint::FriendsCount });
+    *   RoPP::SetBrownout(&brownout);
+    * Only caches that retain expired entries can serve stale, see MemoryCache::RetainStale.
+    */
+    class Brownout
+    {
+        public:
+            Brownout(BrownoutPolicy Policy, std::initializer_list<Endpoint> Endpoints);
+
+            bool Degraded(Endpoint Id) const;
+            bool TryProbe();
+            void Record(bool Healthy, uint64_t Latency);
+            void StaleServed();
+            BrownoutStats Stats();
+
+            const BrownoutPolicy Policy;
+
+        private:
+            static constexpr size_t Buckets = 10;
+
+            struct Bucket
+            {
+                uint64_t Epoch = 0;
+                uint32_t Requests = 0;
+                uint32_t Errors = 0;
+                uint64_t Latency = 0;
+            };
+
+            std::array<bool, static_cast<size_t>(Endpoint::Count)> Selected{};
+            std::atomic<bool> Active{ false };
+            std::atomic<uint64_t> NextProbe{ 0 };
+            std::atomic<uint64_t> Stale{ 0 };
+            std::atomic<uint64_t> Probes{ 0 };
+            std::mutex Mutex;
+            std::array<Bucket, Buckets> Window{};
+            uint32_t HealthyRun = 0;
+            uint64_t Trips = 0;
+    };
+
+    void SetBrownout(Brownout* Controller);
+    Brownout* CurrentBrownout();
+}
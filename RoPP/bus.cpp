@@ -0,0 +1,10 @@
+#include "bus.h"
+
+/*
+* @brief gets the process wide bus the built in watchers can publish to
+*/
+RoPP::EventBus& RoPP::DefaultBus()
+{
+    static EventBus bus;
+    return bus;
+}
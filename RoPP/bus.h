@@ -0,0 +1,442 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+namespace RoPP
+{
+    // what a subscriber that fell more than a ring behind gets back
+    enum class Overflow : uint8_t
+    {
+        DropOldest,    // skip to the oldest event still in the ring, the overwritten ones are lost
+        CoalesceByKey  // additionally get the latest overwritten event of every key, in publish order
+    };
+
+    struct SubscriberStats
+    {
+        uint64_t Delivered = 0;
+        uint64_t Overwritten = 0; // events the ring recycled before this subscriber read them
+        uint64_t Coalesced = 0;   // of those, latest-per-key events recovered by CoalesceByKey
+    };
+
+    struct TopicStats
+    {
+        uint64_t Published = 0;
+        size_t KeyCapacity = 0;  // entries of the latest-value table, 0 without a key function
+        uint64_t Evicted = 0;    // keys pushed out of that table, their older events can no longer be coalesced
+    };
+
+    /*
+    * Values are copied in and out as relaxed atomic words under a per-slot sequence, so a
+    * reader racing a writer sees either a whole event or a torn one it then discards.
+    */
+    template <typename T>
+    class EventWords
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "bus events are copied word by word and must be trivially copyable");
+
+        public:
+            void Store(const T& Value)
+            {
+                uint64_t words[Count] = {};
+                std::memcpy(words, &Value, sizeof(T));
+                for (size_t i = 0; i < Count; i++)
+                    this->Words[i].store(words[i], std::memory_order_relaxed);
+            }
+
+            T Load() const
+            {
+                uint64_t words[Count];
+                for (size_t i = 0; i < Count; i++)
+                    words[i] = this->Words[i].load(std::memory_order_relaxed);
+                T value;
+                std::memcpy(&value, words, sizeof(T));
+                return value;
+            }
+
+        private:
+            static constexpr size_t Count = (sizeof(T) + 7) / 8;
+            std::atomic<uint64_t> Words[Count] = {};
+    };
+
+    template <typename T> class Subscription;
+
+    /*
+    * One typed stream of change events. Publishing claims a sequence number and writes the
+    * event into a power-of-two broadcast ring; it never waits for subscribers, which each
+    * read at their own pace from their own cursor. A subscriber lapped by the ring loses
+    * the overwritten events (Overflow::DropOldest) or, when the topic has a key function,
+    * gets back the latest of them per key (Overflow::CoalesceByKey) from a lock free
+    * latest-value table the publishers keep alongside the ring. A key probes a window of
+    * Probe entries of that table; when all of them hold other keys, the one published
+    * longest ago is evicted (counted in TopicStats::Evicted).
+    * Publishers only ever wait on each other, and only when one is lapped mid-write.
+    */
+    template <typename T>
+    class Topic
+    {
+        public:
+            using KeyFn = std::function<uint64_t(const T&)>;
+
+            Topic(size_t Capacity = 1024, KeyFn KeyOf = nullptr, size_t KeyCapacity = 0)
+                : Mask(std::max<size_t>(RoundUp(Capacity), 2) - 1), Slots(Mask + 1), KeyOf(std::move(KeyOf)),
+                  Latest(this->KeyOf ? RoundUp(std::max<size_t>(KeyCapacity ? KeyCapacity : 4 * (Mask + 1), 2)) : 0)
+            {
+            }
+
+            Topic(const Topic&) = delete;
+            Topic& operator=(const Topic&) = delete;
+
+            /*
+            * @brief appends an event for every subscriber
+            * @return its sequence number
+            */
+            uint64_t Publish(const T& Event)
+            {
+                uint64_t seq = this->Head.fetch_add(1);
+                if (this->KeyOf)
+                    this->Remember(this->KeyOf(Event), seq, Event);
+
+                Slot& slot = this->Slots[seq & this->Mask];
+                // the previous occupant of the slot has to be fully written before it is reused
+                uint64_t previous = seq > this->Mask ? 2 * (seq - this->Mask - 1) + 2 : 0;
+                while (slot.Seq.load(std::memory_order_acquire) != previous)
+                    std::this_thread::yield();
+
+                slot.Seq.store(2 * seq + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.Value.Store(Event);
+                slot.Seq.store(2 * seq + 2, std::memory_order_release);
+                return seq;
+            }
+
+            Subscription<T> Subscribe(Overflow Policy = Overflow::DropOldest)
+            {
+                if (Policy == Overflow::CoalesceByKey && !this->KeyOf)
+                    throw std::invalid_argument("coalescing needs a topic with a key function");
+                return Subscription<T>(this, Policy, this->Head.load());
+            }
+
+            uint64_t Published() const { return this->Head.load(std::memory_order_relaxed); }
+            size_t Capacity() const { return this->Mask + 1; }
+
+            TopicStats Stats() const
+            {
+                TopicStats stats;
+                stats.Published = this->Published();
+                stats.KeyCapacity = this->Latest.size();
+                stats.Evicted = this->Evicted.load(std::memory_order_relaxed);
+                return stats;
+            }
+
+        private:
+            friend class Subscription<T>;
+
+            struct alignas(64) Slot
+            {
+                std::atomic<uint64_t> Seq{ 0 }; // 2s+1 while event s is written, 2s+2 once it is readable
+                EventWords<T> Value;
+            };
+
+            struct Entry
+            {
+                std::atomic<uint64_t> Key{ 0 };     // key + 1, 0 is an empty entry; changes only under Version once claimed
+                std::atomic<uint64_t> Version{ 0 }; // odd while an update is in progress
+                std::atomic<uint64_t> Seq{ 0 };
+                EventWords<T> Value;
+            };
+
+            static size_t RoundUp(size_t Value)
+            {
+                size_t rounded = 1;
+                while (rounded < Value)
+                    rounded <<= 1;
+                return rounded;
+            }
+
+            void Remember(uint64_t Key, uint64_t Seq, const T& Event)
+            {
+                // Key + 1 would wrap to the empty marker, so that one key has an entry of its own
+                if (Key == UINT64_MAX)
+                {
+                    this->Write(this->MaxKey, 0, Seq, Event, false);
+                    return;
+                }
+
+                size_t mask = this->Latest.size() - 1;
+                size_t start = (Key * 0x9E3779B97F4A7C15ull) >> 32 & mask;
+                size_t window = std::min(Probe, mask + 1);
+                for (;;)
+                {
+                    Entry* oldest = nullptr;
+                    size_t probe = 0;
+                    for (; probe < window; probe++)
+                    {
+                        Entry& entry = this->Latest[(start + probe) & mask];
+                        uint64_t stored = entry.Key.load(std::memory_order_acquire);
+                        if (stored == 0 && (entry.Key.compare_exchange_strong(stored, Key + 1) || stored == Key + 1))
+                            stored = Key + 1;
+                        if (stored == Key + 1)
+                            break;
+                        if (!oldest || entry.Seq.load(std::memory_order_relaxed) < oldest->Seq.load(std::memory_order_relaxed))
+                            oldest = &entry;
+                    }
+
+                    if (probe < window)
+                    {
+                        // false when the entry was evicted between the probe and the write, probe again
+                        if (this->Write(this->Latest[(start + probe) & mask], Key + 1, Seq, Event, false))
+                            return;
+                        continue;
+                    }
+
+                    this->Write(*oldest, Key + 1, Seq, Event, true);
+                    this->Evicted.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            /*
+            * @brief updates an entry under its version, or hands it to another key when Evict
+            * @return false when the entry no longer holds Stored
+            */
+            static bool Write(Entry& Target, uint64_t Stored, uint64_t Seq, const T& Event, bool Evict)
+            {
+                uint64_t version = Target.Version.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    if (version & 1)
+                        version = Target.Version.load(std::memory_order_relaxed);
+                    else if (Target.Version.compare_exchange_weak(version, version + 1, std::memory_order_acquire))
+                        break;
+                }
+                // the odd version has to be visible before any field changes, as in Publish
+                std::atomic_thread_fence(std::memory_order_release);
+
+                bool held = Evict || Target.Key.load(std::memory_order_relaxed) == Stored;
+                if (Evict)
+                    Target.Key.store(Stored, std::memory_order_relaxed);
+                // publishers of the same key can finish out of order, keep the newest
+                if (held && (Evict || Target.Seq.load(std::memory_order_relaxed) <= Seq))
+                {
+                    Target.Seq.store(Seq + 1, std::memory_order_relaxed);
+                    Target.Value.Store(Event);
+                }
+                Target.Version.store(version + 2, std::memory_order_release);
+                return held;
+            }
+
+            /*
+            * @brief collects the latest event of every key published in [From, To), for a lapped subscriber
+            */
+            void Recover(uint64_t From, uint64_t To, std::vector<std::pair<uint64_t, T>>& Out) const
+            {
+                // racing evictions can leave a key in two entries for a while, keep its newest
+                std::map<uint64_t, std::pair<uint64_t, T>> newest;
+                auto read = [&](const Entry& entry)
+                {
+                    for (;;)
+                    {
+                        uint64_t version = entry.Version.load(std::memory_order_acquire);
+                        if (version & 1)
+                        {
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        uint64_t key = entry.Key.load(std::memory_order_relaxed);
+                        uint64_t seq = entry.Seq.load(std::memory_order_relaxed);
+                        T value = entry.Value.Load();
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (entry.Version.load(std::memory_order_relaxed) != version)
+                            continue;
+                        if (seq > From && seq <= To)
+                        {
+                            auto found = newest.find(key);
+                            if (found == newest.end() || found->second.first < seq - 1)
+                                newest[key] = { seq - 1, value };
+                        }
+                        return;
+                    }
+                };
+
+                for (const Entry& entry : this->Latest)
+                    if (entry.Key.load(std::memory_order_acquire) != 0)
+                        read(entry);
+                if (this->KeyOf)
+                    read(this->MaxKey);
+
+                for (auto& [key, event] : newest)
+                    Out.push_back(event);
+                std::sort(Out.begin(), Out.end(), [](const auto& A, const auto& B) { return A.first < B.first; });
+            }
+
+            static constexpr size_t Probe = 16;
+
+            const size_t Mask;
+            alignas(64) std::atomic<uint64_t> Head{ 0 };
+            std::vector<Slot> Slots;
+            KeyFn KeyOf;
+            std::vector<Entry> Latest;
+            Entry MaxKey; // UINT64_MAX, stored as key 0
+            std::atomic<uint64_t> Evicted{ 0 };
+    };
+
+    /*
+    * A reader of one topic, owned by a single consumer thread. Starts at the events
+    * published after it was created.
+    */
+    template <typename T>
+    class Subscription
+    {
+        public:
+            /*
+            * @brief takes the next event
+            * @return false when the subscriber has caught up
+            */
+            bool Next(T& Event)
+            {
+                if (!this->Pending.empty())
+                {
+                    Event = this->Pending.front();
+                    this->Pending.pop_front();
+                    this->Counters.Delivered++;
+                    return true;
+                }
+
+                for (;;)
+                {
+                    uint64_t expected = 2 * this->Cursor + 2;
+                    auto& slot = this->Source->Slots[this->Cursor & this->Source->Mask];
+                    uint64_t seq = slot.Seq.load(std::memory_order_acquire);
+                    if (seq < expected)
+                        return false;
+                    if (seq == expected)
+                    {
+                        T value = slot.Value.Load();
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (slot.Seq.load(std::memory_order_relaxed) == expected)
+                        {
+                            Event = value;
+                            this->Cursor++;
+                            this->Counters.Delivered++;
+                            return true;
+                        }
+                    }
+                    if (this->Lapped(Event))
+                        return true;
+                }
+            }
+
+            /*
+            * @brief takes up to Max events
+            * @return how many were appended to Out
+            */
+            size_t Poll(std::vector<T>& Out, size_t Max = SIZE_MAX)
+            {
+                size_t taken = 0;
+                T event;
+                while (taken < Max && this->Next(event))
+                {
+                    Out.push_back(event);
+                    taken++;
+                }
+                return taken;
+            }
+
+            uint64_t Backlog() const
+            {
+                return this->Source->Head.load(std::memory_order_relaxed) - this->Cursor + this->Pending.size();
+            }
+
+            const SubscriberStats& Stats() const { return this->Counters; }
+
+        private:
+            friend class Topic<T>;
+            Subscription(Topic<T>* Source, Overflow Policy, uint64_t Cursor) : Source(Source), Policy(Policy), Cursor(Cursor) {}
+
+            /*
+            * @brief moves a lapped cursor to the oldest event still in the ring
+            * @return true when a coalesced event was put in Event
+            */
+            bool Lapped(T& Event)
+            {
+                uint64_t head = this->Source->Head.load();
+                uint64_t resume = head > this->Source->Mask + 1 ? head - this->Source->Mask - 1 : 0;
+                resume = std::max(resume, this->Cursor + 1);
+                this->Counters.Overwritten += resume - this->Cursor;
+
+                if (this->Policy == Overflow::CoalesceByKey)
+                {
+                    std::vector<std::pair<uint64_t, T>> recovered;
+                    this->Source->Recover(this->Cursor, resume, recovered);
+                    for (auto& [seq, value] : recovered)
+                        this->Pending.push_back(value);
+                    this->Counters.Coalesced += recovered.size();
+                }
+                this->Cursor = resume;
+
+                if (this->Pending.empty())
+                    return false;
+                Event = this->Pending.front();
+                this->Pending.pop_front();
+                this->Counters.Delivered++;
+                return true;
+            }
+
+            Topic<T>* Source;
+            Overflow Policy;
+            uint64_t Cursor;
+            std::deque<T> Pending;
+            SubscriberStats Counters;
+    };
+
+    /*
+    * Named topics shared between the watchers that publish and the subsystems that
+    * subscribe. The first Get of a name creates the topic with the given shape, KeyCapacity
+    * sizing its latest-value table (0 for four times Capacity); asking for an existing name
+    * with another event type throws std::invalid_argument.
+    */
+    class EventBus
+    {
+        public:
+            template <typename T>
+            Topic<T>& Get(const std::string& Name, size_t Capacity = 1024, typename Topic<T>::KeyFn KeyOf = nullptr, size_t KeyCapacity = 0)
+            {
+                std::lock_guard<std::mutex> lock(this->Mutex);
+                auto found = this->Topics.find(Name);
+                if (found == this->Topics.end())
+                {
+                    auto topic = std::make_shared<Topic<T>>(Capacity, std::move(KeyOf), KeyCapacity);
+                    this->Topics.emplace(Name, Registered{ std::type_index(typeid(T)), topic });
+                    return *topic;
+                }
+                if (found->second.Type != std::type_index(typeid(T)))
+                    throw std::invalid_argument("topic " + Name + " carries another event type");
+                return *std::static_pointer_cast<Topic<T>>(found->second.Instance);
+            }
+
+        private:
+            struct Registered
+            {
+                std::type_index Type;
+                std::shared_ptr<void> Instance;
+            };
+
+            std::mutex Mutex;
+            std::map<std::string, Registered> Topics;
+    };
+
+    EventBus& DefaultBus();
+}
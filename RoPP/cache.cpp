@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cache.h"
+
+/*
+* @brief looks up a live entry and marks it most recently used
+* @return true when the key was present and not expired
+*/
+bool RoPP::MemoryCache::Get(const std::string& Key, std::string& Value)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto it = this->Index.find(Key);
+    if (it == this->Index.end())
+        return false;
+
+    auto now = std::chrono::steady_clock::now();
+    if (it->second->Expires <= now)
+    {
+        // expired entries stay for stale reads until the grace period runs out or LRU evicts them
+        if (it->second->Expires + this->Grace <= now)
+        {
+            this->Entries.erase(it->second);
+            this->Index.erase(it);
+        }
+        return false;
+    }
+
+    this->Entries.splice(this->Entries.begin(), this->Entries, it->second);
+    Value = it->second->Value;
+    return true;
+}
+
+/*
+* @brief looks up an entry that may have expired, as long as it is at most MaxStaleness past its ttl
+* @return true when a live or acceptably stale entry was present
+*/
+bool RoPP::MemoryCache::GetStale(const std::string& Key, std::string& Value, std::chrono::seconds MaxStaleness)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto it = this->Index.find(Key);
+    if (it == this->Index.end() || it->second->Expires + MaxStaleness <= std::chrono::steady_clock::now())
+        return false;
+
+    this->Entries.splice(this->Entries.begin(), this->Entries, it->second);
+    Value = it->second->Value;
+    return true;
+}
+
+/*
+* @brief keeps entries for Grace past their ttl so GetStale can still serve them, 0 drops them on expiry
+*/
+void RoPP::MemoryCache::RetainStale(std::chrono::seconds Grace)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Grace = Grace;
+}
+
+/*
+* @brief stores an entry with the cache wide ttl
+*/
+void RoPP::MemoryCache::Put(const std::string& Key, const std::string& Value)
+{
+    this->Put(Key, Value, this->Ttl);
+}
+
+/*
+* @brief stores an entry, evicting the least recently used one when full
+*/
+void RoPP::MemoryCache::Put(const std::string& Key, const std::string& Value, std::chrono::seconds Ttl)
+{
+    auto expires = std::chrono::steady_clock::now() + Ttl;
+
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto it = this->Index.find(Key);
+    if (it != this->Index.end())
+    {
+        it->second->Value = Value;
+        it->second->Expires = expires;
+        this->Entries.splice(this->Entries.begin(), this->Entries, it->second);
+        return;
+    }
+
+    if (this->Capacity == 0)
+        return;
+    if (this->Entries.size() >= this->Capacity)
+    {
+        this->Index.erase(this->Entries.back().Key);
+        this->Entries.pop_back();
+    }
+
+    this->Entries.push_front({ Key, Value, expires });
+    this->Index[Key] = this->Entries.begin();
+}
+
+/*
+* @brief gets the number of stored entries, expired ones included
+* @return entry count
+*/
+size_t RoPP::MemoryCache::Size()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return this->Entries.size();
+}
+
+static void _m_put32(std::string& out, uint32_t value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static uint32_t _m_get32(const char* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+void RoPP::CacheProtocol::EncodeRequest(std::string& Out, uint8_t Op, uint32_t Id, const std::string& Key, const std::string& Value, uint32_t Ttl)
+{
+    Out.push_back(static_cast<char>(Op));
+    _m_put32(Out, Id);
+    _m_put32(Out, Ttl);
+    _m_put32(Out, static_cast<uint32_t>(Key.size()));
+    _m_put32(Out, static_cast<uint32_t>(Value.size()));
+    Out += Key;
+    Out += Value;
+}
+
+void RoPP::CacheProtocol::EncodeResponse(std::string& Out, uint8_t Status, uint32_t Id, const std::string& Value)
+{
+    Out.push_back(static_cast<char>(Status));
+    _m_put32(Out, Id);
+    _m_put32(Out, static_cast<uint32_t>(Value.size()));
+    Out += Value;
+}
+
+/*
+* @brief decodes one request frame from the front of a buffer
+* @return bytes consumed, 0 when incomplete
+*/
+size_t RoPP::CacheProtocol::DecodeRequest(const char* Data, size_t Size, RequestFrame& Frame)
+{
+    if (Size < RequestHeaderSize)
+        return 0;
+
+    uint32_t keySize = _m_get32(Data + 9);
+    uint32_t valueSize = _m_get32(Data + 13);
+    if (keySize > MaxFieldSize || valueSize > MaxFieldSize)
+        throw std::runtime_error("cache frame too large");
+    if (Size < RequestHeaderSize + keySize + valueSize)
+        return 0;
+
+    Frame.Op = static_cast<uint8_t>(Data[0]);
+    Frame.Id = _m_get32(Data + 1);
+    Frame.Ttl = _m_get32(Data + 5);
+    Frame.Key.assign(Data + RequestHeaderSize, keySize);
+    Frame.Value.assign(Data + RequestHeaderSize + keySize, valueSize);
+
+    return RequestHeaderSize + keySize + valueSize;
+}
+
+/*
+* @brief decodes one response frame from the front of a buffer
+* @return bytes consumed, 0 when incomplete
+*/
+size_t RoPP::CacheProtocol::DecodeResponse(const char* Data, size_t Size, ResponseFrame& Frame)
+{
+    if (Size < ResponseHeaderSize)
+        return 0;
+
+    uint32_t valueSize = _m_get32(Data + 5);
+    if (valueSize > MaxFieldSize)
+        throw std::runtime_error("cache frame too large");
+    if (Size < ResponseHeaderSize + valueSize)
+        return 0;
+
+    Frame.Status = static_cast<uint8_t>(Data[0]);
+    Frame.Id = _m_get32(Data + 1);
+    Frame.Value.assign(Data + ResponseHeaderSize, valueSize);
+
+    return ResponseHeaderSize + valueSize;
+}
+
+RoPP::CacheClient::CacheClient(const std::string& SocketPath, bool FetchOnMiss) : FetchOnMiss(FetchOnMiss)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (SocketPath.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("cache socket path too long");
+    std::memcpy(addr.sun_path, SocketPath.c_str(), SocketPath.size() + 1);
+
+    this->Socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (this->Socket < 0 || connect(this->Socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        if (this->Socket >= 0)
+            close(this->Socket);
+        throw std::runtime_error("cannot connect to cache daemon at " + SocketPath);
+    }
+}
+
+RoPP::CacheClient::~CacheClient()
+{
+    if (this->Socket >= 0)
+        close(this->Socket);
+}
+
+/*
+* @brief looks a key up in the daemon, letting it fetch the url on a miss when FetchOnMiss is set
+* @return true when a value was returned
+*/
+bool RoPP::CacheClient::Get(const std::string& Key, std::string& Value)
+{
+    auto values = this->GetMany({ Key });
+    if (!values[0])
+        return false;
+
+    Value = std::move(*values[0]);
+    return true;
+}
+
+/*
+* @brief stores a value in the daemon, does not wait for an acknowledgement
+*/
+void RoPP::CacheClient::Put(const std::string& Key, const std::string& Value)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::string frame;
+    CacheProtocol::EncodeRequest(frame, CacheProtocol::Put, this->NextId++, Key, Value);
+    this->Send(frame);
+}
+
+/*
+* @brief stores a value in the daemon with its own ttl, clamped to what the protocol carries
+*/
+void RoPP::CacheClient::Put(const std::string& Key, const std::string& Value, std::chrono::seconds Ttl)
+{
+    uint32_t ttl = static_cast<uint32_t>(std::min<long long>(std::max<long long>(Ttl.count(), 1), UINT32_MAX));
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::string frame;
+    CacheProtocol::EncodeRequest(frame, CacheProtocol::Put, this->NextId++, Key, Value, ttl);
+    this->Send(frame);
+}
+
+/*
+* @brief pipelines a batch of lookups in a single write and collects the out of order replies
+* @return one value per key, empty on a miss
+*/
+std::vector<std::optional<std::string>> RoPP::CacheClient::GetMany(const std::vector<std::string>& Keys)
+{
+    uint8_t op = this->FetchOnMiss ? CacheProtocol::Fetch : CacheProtocol::Get;
+    // the replies of this batch are read before another thread may send
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    uint32_t first = this->NextId;
+
+    std::string batch;
+    for (auto& key : Keys)
+        CacheProtocol::EncodeRequest(batch, op, this->NextId++, key);
+    this->Send(batch);
+
+    std::vector<std::optional<std::string>> values(Keys.size());
+    for (size_t received = 0; received < Keys.size(); received++)
+    {
+        CacheProtocol::ResponseFrame frame;
+        this->Receive(frame);
+
+        uint32_t slot = frame.Id - first;
+        if (slot >= Keys.size())
+            throw std::runtime_error("unexpected cache response id");
+        if (frame.Status == CacheProtocol::Hit)
+            values[slot] = std::move(frame.Value);
+    }
+
+    return values;
+}
+
+void RoPP::CacheClient::Send(const std::string& Data)
+{
+    size_t sent = 0;
+    while (sent < Data.size())
+    {
+        ssize_t n = send(this->Socket, Data.data() + sent, Data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            throw std::runtime_error("cache daemon connection lost");
+        sent += n;
+    }
+}
+
+void RoPP::CacheClient::Receive(CacheProtocol::ResponseFrame& Frame)
+{
+    for (;;)
+    {
+        size_t used = CacheProtocol::DecodeResponse(this->Buffer.data(), this->Buffer.size(), Frame);
+        if (used)
+        {
+            this->Buffer.erase(0, used);
+            return;
+        }
+
+        char chunk[16384];
+        ssize_t n = recv(this->Socket, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+            throw std::runtime_error("cache daemon connection lost");
+        this->Buffer.append(chunk, n);
+    }
+}
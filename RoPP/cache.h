@@ -0,0 +1,128 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RoPP
+{
+    /*
+    * Implementations must be safe to call from several threads at once: the batch calls
+    * (Game, Badge, Friends) share one cache between their workers.
+    */
+    class Cache
+    {
+        public:
+            virtual ~Cache() = default;
+            // longest ttl every cache accepts, for entries that never go out of date
+            static constexpr std::chrono::seconds Forever{ 3153600000 };
+
+            virtual bool Get(const std::string& Key, std::string& Value) = 0;
+            virtual void Put(const std::string& Key, const std::string& Value) = 0;
+
+            // caches without per entry ttls keep their own
+            virtual void Put(const std::string& Key, const std::string& Value, std::chrono::seconds /* Ttl */)
+            {
+                this->Put(Key, Value);
+            }
+
+            // expired entries up to MaxStaleness past their ttl, for caches that keep them
+            virtual bool GetStale(const std::string& Key, std::string& Value, std::chrono::seconds /* MaxStaleness */)
+            {
+                return this->Get(Key, Value);
+            }
+    };
+
+    class MemoryCache : public Cache
+    {
+        public:
+            MemoryCache(size_t Capacity = 4096, std::chrono::seconds Ttl = std::chrono::seconds(60)) : Capacity(Capacity), Ttl(Ttl) {}
+
+            bool Get(const std::string& Key, std::string& Value) override;
+            bool GetStale(const std::string& Key, std::string& Value, std::chrono::seconds MaxStaleness) override;
+            void Put(const std::string& Key, const std::string& Value) override;
+            void Put(const std::string& Key, const std::string& Value, std::chrono::seconds Ttl) override;
+            void RetainStale(std::chrono::seconds Grace);
+            size_t Size();
+
+        private:
+            struct Entry
+            {
+                std::string Key;
+                std::string Value;
+                std::chrono::steady_clock::time_point Expires;
+            };
+
+            size_t Capacity;
+            std::chrono::seconds Ttl;
+            std::chrono::seconds Grace{ 0 };
+            std::mutex Mutex;
+            std::list<Entry> Entries;
+            std::unordered_map<std::string, std::list<Entry>::iterator> Index;
+    };
+
+    /*
+    * Wire format spoken by the ropp_cached daemon, host byte order (both ends share a host).
+    * request:  u8 op | u32 id | u32 ttl | u32 key length | u32 value length | key | value
+    * response: u8 status | u32 id | u32 value length | value
+    * Responses carry the request id and may arrive out of order; Put never gets a response.
+    */
+    namespace CacheProtocol
+    {
+        enum Op : uint8_t { Get = 1, Fetch = 2, Put = 3 };
+        enum Status : uint8_t { Hit = 0, Miss = 1, Error = 2 };
+
+        constexpr size_t RequestHeaderSize = 17;
+        constexpr size_t ResponseHeaderSize = 9;
+        constexpr uint32_t MaxFieldSize = 64 * 1024 * 1024;
+
+        struct RequestFrame
+        {
+            uint8_t Op;
+            uint32_t Id;
+            uint32_t Ttl;
+            std::string Key;
+            std::string Value;
+        };
+
+        struct ResponseFrame
+        {
+            uint8_t Status;
+            uint32_t Id;
+            std::string Value;
+        };
+
+        void EncodeRequest(std::string& Out, uint8_t Op, uint32_t Id, const std::string& Key, const std::string& Value = "", uint32_t Ttl = 0);
+        void EncodeResponse(std::string& Out, uint8_t Status, uint32_t Id, const std::string& Value = "");
+        // return the number of bytes consumed, 0 when the buffer holds no complete frame
+        size_t DecodeRequest(const char* Data, size_t Size, RequestFrame& Frame);
+        size_t DecodeResponse(const char* Data, size_t Size, ResponseFrame& Frame);
+    }
+
+    // one connection shared by every thread, requests and their replies are serialised on it
+    class CacheClient : public Cache
+    {
+        public:
+            CacheClient(const std::string& SocketPath, bool FetchOnMiss = true);
+            ~CacheClient();
+
+            bool Get(const std::string& Key, std::string& Value) override;
+            void Put(const std::string& Key, const std::string& Value) override;
+            void Put(const std::string& Key, const std::string& Value, std::chrono::seconds Ttl) override;
+            std::vector<std::optional<std::string>> GetMany(const std::vector<std::string>& Keys);
+
+        private:
+            void Send(const std::string& Data);
+            void Receive(CacheProtocol::ResponseFrame& Frame);
+
+            std::mutex Mutex; // guards the socket, NextId and Buffer
+            int Socket = -1;
+            bool FetchOnMiss;
+            uint32_t NextId = 1;
+            std::string Buffer;
+    };
+}
@@ -0,0 +1,68 @@
+#include "connection.h"
+
+RoPP::CurlShare::CurlShare(bool Connections, bool Sessions, bool Dns)
+{
+    this->Share = curl_share_init();
+    if (Connections)
+        curl_share_setopt(this->Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    if (Sessions)
+        curl_share_setopt(this->Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    if (Dns)
+        curl_share_setopt(this->Share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(this->Share, CURLSHOPT_LOCKFUNC, &CurlShare::Lock);
+    curl_share_setopt(this->Share, CURLSHOPT_UNLOCKFUNC, &CurlShare::Unlock);
+    curl_share_setopt(this->Share, CURLSHOPT_USERDATA, this);
+}
+
+RoPP::CurlShare::~CurlShare()
+{
+    curl_share_cleanup(this->Share);
+}
+
+void RoPP::CurlShare::Lock(CURL*, curl_lock_data Data, curl_lock_access, void* User)
+{
+    static_cast<CurlShare*>(User)->Locks[Data].lock();
+}
+
+void RoPP::CurlShare::Unlock(CURL*, curl_lock_data Data, void* User)
+{
+    static_cast<CurlShare*>(User)->Locks[Data].unlock();
+}
+
+/*
+* @brief sets the socket, keepalive and TLS options of a tuning on a handle
+* @param Share pool the handle draws connections and sessions from, nullptr for none
+*/
+void RoPP::ApplyTuning(CURL* Handle, const ConnectionTuning& Tuning, CurlShare* Share)
+{
+    if (Share)
+        curl_easy_setopt(Handle, CURLOPT_SHARE, Share->Handle());
+    if (!Tuning.ReuseConnections)
+        curl_easy_setopt(Handle, CURLOPT_FORBID_REUSE, 1L);
+    curl_easy_setopt(Handle, CURLOPT_SSL_SESSIONID_CACHE, Tuning.ResumeSessions ? 1L : 0L);
+    curl_easy_setopt(Handle, CURLOPT_TCP_FASTOPEN, Tuning.FastOpen ? 1L : 0L);
+    curl_easy_setopt(Handle, CURLOPT_TCP_NODELAY, Tuning.NoDelay ? 1L : 0L);
+    curl_easy_setopt(Handle, CURLOPT_TCP_KEEPALIVE, Tuning.KeepAlive ? 1L : 0L);
+    if (Tuning.KeepAlive)
+    {
+        curl_easy_setopt(Handle, CURLOPT_TCP_KEEPIDLE, static_cast<long>(Tuning.KeepIdle.count()));
+        curl_easy_setopt(Handle, CURLOPT_TCP_KEEPINTVL, static_cast<long>(Tuning.KeepInterval.count()));
+    }
+    curl_easy_setopt(Handle, CURLOPT_MAXAGE_CONN, static_cast<long>(Tuning.IdleTimeout.count()));
+    curl_easy_setopt(Handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(Tuning.ConnectTimeout).count()));
+    if (!Tuning.CaBundle.empty())
+        curl_easy_setopt(Handle, CURLOPT_CAINFO, Tuning.CaBundle.c_str());
+}
+
+RoPP::TunedTransport::TunedTransport(ConnectionTuning Tuning) : Tuning(Tuning), Share(Tuning.ReuseConnections, Tuning.ResumeSessions)
+{
+}
+
+/*
+* @brief performs the request on a pooled connection when one is idle, a new tuned one otherwise
+* @return the response of the request
+*/
+Response RoPP::TunedTransport::Get(const TransportRequest& Req)
+{
+    return this->Perform(Req, [this](CURL* Handle) { ApplyTuning(Handle, this->Tuning, &this->Share); });
+}
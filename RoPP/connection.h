@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "transport.h"
+
+namespace RoPP
+{
+    // socket and TLS settings for the connections a transport opens
+    struct ConnectionTuning
+    {
+        bool ReuseConnections = true;              // keep finished connections open for the next request
+        bool ResumeSessions = true;                // cache TLS session tickets per host for abbreviated handshakes
+        bool FastOpen = false;                     // TCP Fast Open, needs net.ipv4.tcp_fastopen on both ends
+        bool NoDelay = true;
+        bool KeepAlive = true;
+        std::chrono::seconds KeepIdle{ 30 };       // idle time before the first keepalive probe
+        std::chrono::seconds KeepInterval{ 15 };
+        std::chrono::seconds IdleTimeout{ 118 };   // an idle pooled connection older than this is not reused
+        std::chrono::seconds ConnectTimeout{ 10 };
+        std::string CaBundle;                      // extra trust anchors, empty uses the system store
+    };
+
+    // curl share handle with the locking curl needs to use it from several threads
+    class CurlShare
+    {
+        public:
+            CurlShare(bool Connections, bool Sessions, bool Dns = true);
+            ~CurlShare();
+            CurlShare(const CurlShare&) = delete;
+            CurlShare& operator=(const CurlShare&) = delete;
+
+            CURLSH* Handle() const { return this->Share; }
+
+        private:
+            static void Lock(CURL*, curl_lock_data Data, curl_lock_access, void* User);
+            static void Unlock(CURL*, curl_lock_data Data, void* User);
+
+            CURLSH* Share;
+            std::mutex Locks[CURL_LOCK_DATA_LAST];
+    };
+
+    void ApplyTuning(CURL* Handle, const ConnectionTuning& Tuning, CurlShare* Share);
+
+    /*
+    * CurlTransport whose requests share a connection pool, a DNS cache and a TLS session
+    * cache, so a burst after a quiet spell reuses a warm connection or at least resumes
+    * the TLS session instead of paying a full handshake:
+    *   RoPP::TunedTransport tuned;
+    *   RoPP::SetDefaultTransport(&tuned);
+    */
+    class TunedTransport : public CurlTransport
+    {
+        public:
+            explicit TunedTransport(ConnectionTuning Tuning = {});
+
+            Response Get(const TransportRequest& Req) override;
+
+            const ConnectionTuning Tuning;
+
+        private:
+            CurlShare Share;
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+
+namespace RoPP
+{
+    // emitted as raw ids by the USDT probes and binary log records, append new endpoints just before Count
+    enum class Endpoint : uint16_t
+    {
+        Unknown,
+        UserInfo,
+        Friends,
+        FriendsOnline,
+        FriendsCount,
+        Followers,
+        FollowersCount,
+        Followings,
+        FollowingsCount,
+        Groups,
+        GameDetails,
+        PlaceDetails,
+        BadgeAwards,
+        Ownership,
+        Inventory,
+        FriendStatuses,
+        Count
+    };
+
+    inline const char* EndpointName(Endpoint Id)
+    {
+        switch (Id)
+        {
+        case Endpoint::UserInfo: return "UserInfo";
+        case Endpoint::Friends: return "Friends";
+        case Endpoint::FriendsOnline: return "FriendsOnline";
+        case Endpoint::FriendsCount: return "FriendsCount";
+        case Endpoint::Followers: return "Followers";
+        case Endpoint::FollowersCount: return "FollowersCount";
+        case Endpoint::Followings: return "Followings";
+        case Endpoint::FollowingsCount: return "FollowingsCount";
+        case Endpoint::Groups: return "Groups";
+        case Endpoint::GameDetails: return "GameDetails";
+        case Endpoint::PlaceDetails: return "PlaceDetails";
+        case Endpoint::BadgeAwards: return "BadgeAwards";
+        case Endpoint::Ownership: return "Ownership";
+        case Endpoint::Inventory: return "Inventory";
+        case Endpoint::FriendStatuses: return "FriendStatuses";
+        default: return "Unknown";
+        }
+    }
+}
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "fault.h"
+
+// splitmix64, small and identical on every platform unlike the <random> distributions
+static uint64_t _m_mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t _m_hash(const std::string& Text)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : Text)
+        hash = (hash ^ c) * 0x100000001b3ull;
+    return hash;
+}
+
+namespace
+{
+struct _m_Draws
+{
+    uint64_t State;
+
+    // uniform in (0, 1)
+    double Next()
+    {
+        State = _m_mix(State);
+        return ((State >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    }
+};
+}
+
+RoPP::LatencyModel RoPP::LatencyModel::Constant(std::chrono::microseconds Delay)
+{
+    LatencyModel model;
+    model.Shape = Kind::Constant;
+    model.Base = Delay;
+    return model;
+}
+
+RoPP::LatencyModel RoPP::LatencyModel::Uniform(std::chrono::microseconds Min, std::chrono::microseconds Max)
+{
+    LatencyModel model;
+    model.Shape = Kind::Uniform;
+    model.Base = Min;
+    model.Scale = Max - Min;
+    return model;
+}
+
+RoPP::LatencyModel RoPP::LatencyModel::Exponential(std::chrono::microseconds Mean)
+{
+    LatencyModel model;
+    model.Shape = Kind::Exponential;
+    model.Scale = Mean;
+    return model;
+}
+
+RoPP::LatencyModel RoPP::LatencyModel::LogNormal(std::chrono::microseconds Median, double Sigma)
+{
+    LatencyModel model;
+    model.Shape = Kind::LogNormal;
+    model.Scale = Median;
+    model.Spread = Sigma;
+    return model;
+}
+
+RoPP::LatencyModel RoPP::LatencyModel::Pareto(std::chrono::microseconds Minimum, double Alpha)
+{
+    LatencyModel model;
+    model.Shape = Kind::Pareto;
+    model.Scale = Minimum;
+    model.Spread = Alpha;
+    return model;
+}
+
+static uint64_t _m_latency(const RoPP::LatencyModel& Model, _m_Draws& Draws)
+{
+    using Kind = RoPP::LatencyModel::Kind;
+    double scale = static_cast<double>(Model.Scale.count());
+    double extra = 0;
+    switch (Model.Shape)
+    {
+    case Kind::None:
+        return 0;
+    case Kind::Constant:
+        break;
+    case Kind::Uniform:
+        extra = scale * Draws.Next();
+        break;
+    case Kind::Exponential:
+        extra = -scale * std::log(Draws.Next());
+        break;
+    case Kind::LogNormal:
+    {
+        // Box-Muller, one normal per request is enough
+        double normal = std::sqrt(-2.0 * std::log(Draws.Next())) * std::cos(6.283185307179586 * Draws.Next());
+        extra = scale * std::exp(Model.Spread * normal);
+        break;
+    }
+    case Kind::Pareto:
+        extra = scale / std::pow(Draws.Next(), 1.0 / Model.Spread);
+        break;
+    }
+
+    uint64_t total = static_cast<uint64_t>(Model.Base.count()) + static_cast<uint64_t>(std::min(extra, 1e12));
+    if (Model.Cap.count() > 0)
+        total = std::min<uint64_t>(total, Model.Cap.count());
+    return total;
+}
+
+const char* RoPP::FaultName(Fault Kind)
+{
+    switch (Kind)
+    {
+    case Fault::Reset: return "reset";
+    case Fault::Partial: return "partial";
+    case Fault::Throttle: return "throttle";
+    case Fault::SlowDrip: return "slow_drip";
+    default: return "none";
+    }
+}
+
+/*
+* @brief performs the request through the inner transport with the profile's faults applied
+* @return the inner response, degraded, or a synthesized reset or 429
+*/
+Response RoPP::FaultTransport::Get(const TransportRequest& Req)
+{
+    _m_Draws draws;
+    FaultProfile profile;
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        profile = this->Profile;
+        uint64_t attempt = this->Attempts[Req.Url]++;
+        draws.State = _m_mix(profile.Seed ^ _m_mix(_m_hash(Req.Url)) ^ _m_mix(attempt + 1));
+    }
+    this->Requests++;
+
+    uint64_t delay = _m_latency(profile.Latency, draws);
+    double roll = draws.Next();
+    double cut = draws.Next();
+
+    Fault fault = Fault::None;
+    double edge = profile.ResetRate;
+    if (roll < edge)
+        fault = Fault::Reset;
+    else if (roll < (edge += profile.ThrottleRate))
+        fault = Fault::Throttle;
+    else if (roll < (edge += profile.PartialRate))
+        fault = Fault::Partial;
+    else if (roll < (edge += profile.SlowDripRate))
+        fault = Fault::SlowDrip;
+    this->Faults[static_cast<size_t>(fault)]++;
+
+    if (delay)
+    {
+        this->InjectedLatency += delay;
+        std::this_thread::sleep_for(std::chrono::microseconds(delay));
+        if (Req.Profile)
+            Req.Profile->Ttfb += delay * 1000;
+    }
+
+    Response res{};
+    if (fault == Fault::Reset)
+    {
+        res.curlCode = CURLE_RECV_ERROR;
+        res.timings.startTransfer = res.timings.total = delay;
+        return res;
+    }
+    if (fault == Fault::Throttle)
+    {
+        res.curlCode = CURLE_OK;
+        res.code = 429;
+        res.message = "Too Many Requests";
+        res.data = "{\"errors\":[{\"code\":0,\"message\":\"Too many requests\"}]}";
+        res.headers["retry-after"] = std::to_string(profile.RetryAfter.count());
+        res.timings.startTransfer = res.timings.total = delay;
+        return res;
+    }
+
+    res = this->Inner.Get(Req);
+    res.timings.startTransfer += delay;
+    res.timings.total += delay;
+    if (res.curlCode != CURLE_OK)
+        return res;
+
+    if (fault == Fault::Partial && !res.data.empty())
+    {
+        // the connection drops somewhere inside the body, curl reports what arrived
+        res.data.resize(static_cast<size_t>(cut * res.data.size()));
+        res.rawData.resize(res.data.size());
+        res.curlCode = CURLE_PARTIAL_FILE;
+    }
+    else if (fault == Fault::SlowDrip && profile.DripBytes)
+    {
+        // body trickles in DripBytes per DripInterval after the first chunk
+        size_t chunks = (res.data.size() + profile.DripBytes - 1) / profile.DripBytes;
+        auto drip = profile.DripInterval * (chunks > 1 ? chunks - 1 : 0);
+        std::this_thread::sleep_for(drip);
+
+        uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(drip).count();
+        this->InjectedLatency += us;
+        res.timings.total += us;
+        if (Req.Profile)
+            Req.Profile->Receive += us * 1000;
+    }
+    return res;
+}
+
+/*
+* @brief gets how many requests went through and which faults they got
+*/
+RoPP::FaultStats RoPP::FaultTransport::Stats()
+{
+    FaultStats stats;
+    stats.Requests = this->Requests.load();
+    stats.InjectedLatency = this->InjectedLatency.load();
+    for (size_t i = 0; i < static_cast<size_t>(Fault::Count); i++)
+        stats.Faults[i] = this->Faults[i].load();
+    return stats;
+}
+
+/*
+* @brief starts a new deterministic run, forgetting attempt counts and stats
+*/
+void RoPP::FaultTransport::Reseed(uint64_t Seed)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Profile.Seed = Seed;
+    this->Attempts.clear();
+    this->Requests = 0;
+    this->InjectedLatency = 0;
+    for (auto& count : this->Faults)
+        count = 0;
+}
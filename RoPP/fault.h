@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "transport.h"
+
+namespace RoPP
+{
+    // added latency drawn per request, durations in microseconds
+    struct LatencyModel
+    {
+        enum class Kind : uint8_t { None, Constant, Uniform, Exponential, LogNormal, Pareto };
+
+        Kind Shape = Kind::None;
+        std::chrono::microseconds Base{ 0 };   // always added
+        std::chrono::microseconds Scale{ 0 };  // uniform width, exponential mean, lognormal median, pareto minimum
+        double Spread = 1.0;                   // lognormal sigma, pareto alpha
+        std::chrono::microseconds Cap{ 0 };    // 0 leaves the tail uncapped
+
+        static LatencyModel Constant(std::chrono::microseconds Delay);
+        static LatencyModel Uniform(std::chrono::microseconds Min, std::chrono::microseconds Max);
+        static LatencyModel Exponential(std::chrono::microseconds Mean);
+        static LatencyModel LogNormal(std::chrono::microseconds Median, double Sigma);
+        static LatencyModel Pareto(std::chrono::microseconds Minimum, double Alpha);
+    };
+
+    enum class Fault : uint8_t { None, Reset, Partial, Throttle, SlowDrip, Count };
+
+    const char* FaultName(Fault Kind);
+
+    /*
+    * What FaultTransport does to requests. Rates are probabilities per request and are
+    * drawn in order reset, throttle, partial, slow drip, so they should sum to at most 1.
+    * Reset and throttle answer without calling the inner transport; partial and slow drip
+    * degrade its real response.
+    */
+    struct FaultProfile
+    {
+        uint64_t Seed = 1;
+        LatencyModel Latency;
+        double ResetRate = 0;
+        double ThrottleRate = 0;
+        std::chrono::seconds RetryAfter{ 1 };
+        double PartialRate = 0;
+        double SlowDripRate = 0;
+        size_t DripBytes = 512;
+        std::chrono::milliseconds DripInterval{ 5 };
+    };
+
+    struct FaultStats
+    {
+        uint64_t Requests = 0;
+        uint64_t InjectedLatency = 0; // microseconds
+        uint64_t Faults[static_cast<size_t>(Fault::Count)] = {};
+    };
+
+    /*
+    * Transport decorator that injects latency and failures in front of a real transport:
+    *   RoPP::CurlTransport curl;
+    *   RoPP::FaultTransport faults(curl, profile);
+    *   RoPP::SetDefaultTransport(&faults);
+    * Every decision is a pure function of the seed, the url and how many times that url was
+    * requested before, so a run replays the same faults whatever the thread interleaving.
+    */
+    class FaultTransport : public Transport
+    {
+        public:
+            FaultTransport(Transport& Inner, FaultProfile Profile) : Inner(Inner), Profile(Profile) {}
+
+            Response Get(const TransportRequest& Req) override;
+            FaultStats Stats();
+            void Reseed(uint64_t Seed);
+
+        private:
+            Transport& Inner;
+            FaultProfile Profile;
+            std::mutex Mutex;
+            std::unordered_map<std::string, uint64_t> Attempts;
+            std::atomic<uint64_t> Requests{ 0 };
+            std::atomic<uint64_t> InjectedLatency{ 0 };
+            std::atomic<uint64_t> Faults[static_cast<size_t>(Fault::Count)] = {};
+    };
+}
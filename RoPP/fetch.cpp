@@ -0,0 +1,111 @@
+#include <string>
+
+#include "alloc.h"
+#include "brownout.h"
+#include "json.h"
+#include "log.h"
+#include "probes.h"
+#include "ropp.h"
+
+/*
+* @brief gets the body of a roblox api url, consulting the cache layer first
+* @param CacheLayer optional cache, successful responses are stored back into it
+* @param Id endpoint the url belongs to, used to label traces
+* @return response body, empty when the transfer failed
+*/
+std::string RoPP::Fetch(const string& Url, Cache* CacheLayer, Endpoint Id)
+{
+    TraceCall call(Id);
+    CallProfile* profile = ProfileScope::Active();
+    if (profile)
+        profile->Id = Id;
+
+    std::string body;
+    if (CacheLayer)
+    {
+        TraceSpan lookup(SpanKind::CacheLookup);
+        bool timed = profile || ROPP_PROBE_ENABLED(cache_hit) || ROPP_PROBE_ENABLED(cache_miss);
+        uint64_t begin = timed ? Tracer::Now() : 0;
+
+        bool hit;
+        {
+            ROPP_ALLOC_SCOPE(Cache);
+            hit = CacheLayer->Get(Url, body);
+        }
+        if (profile)
+        {
+            profile->Cache += Tracer::Now() - begin;
+            profile->CacheHits += hit;
+        }
+
+        if (hit)
+        {
+            ROPP_LOG(LogLevel::Trace, LogEvent::CacheHit, Id, 0, body.size(), 0);
+            if (ROPP_PROBE_ENABLED(cache_hit))
+                ROPP_PROBE(cache_hit, Id, body.size(), Tracer::Now() - begin);
+            return body;
+        }
+        ROPP_LOG(LogLevel::Trace, LogEvent::CacheMiss, Id, 0, 0, 0);
+        if (ROPP_PROBE_ENABLED(cache_miss))
+            ROPP_PROBE(cache_miss, Id, 0, Tracer::Now() - begin);
+    }
+
+    // during a brownout a miss is answered from stale entries, except for the odd probe
+    Brownout* brownout = CacheLayer ? CurrentBrownout() : nullptr;
+    auto serveStale = [&]
+    {
+        ROPP_ALLOC_SCOPE(Cache);
+        if (!CacheLayer->GetStale(Url, body, brownout->Policy.MaxStaleness))
+            return false;
+        brownout->StaleServed();
+        ROPP_LOG(LogLevel::Debug, LogEvent::StaleServed, Id, 0, body.size(), 0);
+        return true;
+    };
+    if (brownout && brownout->Degraded(Id) && !brownout->TryProbe() && serveStale())
+        return body;
+
+    uint64_t sent = brownout ? Tracer::Now() : 0;
+    Response res = DefaultTransport().Get({ Url, { { "Referer", "https://www.roblox.com/" } }, Id, Tracer::Current(), profile });
+
+    if (brownout)
+    {
+        bool healthy = res.curlCode == CURLE_OK && res.code < 500 && res.code != 429;
+        brownout->Record(healthy, Tracer::Now() - sent);
+        if (!healthy && brownout->Degraded(Id) && serveStale())
+            return body;
+    }
+
+    if (CacheLayer && res.curlCode == CURLE_OK && res.code == 200)
+    {
+        ROPP_ALLOC_SCOPE(Cache);
+        CacheLayer->Put(Url, res.data);
+    }
+
+    return res.data;
+}
+
+/*
+* @brief gets and parses the body of a roblox api url, see Fetch
+* @return parsed json body
+*/
+json RoPP::FetchJson(const string& Url, Cache* CacheLayer, Endpoint Id)
+{
+    TraceCall call(Id);
+    std::string body = Fetch(Url, CacheLayer, Id);
+
+    TraceSpan parse(SpanKind::Parse);
+    ROPP_ALLOC_SCOPE(Json);
+    CallProfile* profile = ProfileScope::Active();
+    if (!profile && !ROPP_PROBE_ENABLED(parse_start) && !ROPP_PROBE_ENABLED(parse_done))
+        return ParseJson(body);
+
+    ROPP_PROBE(parse_start, Id, body.size(), 0);
+    uint64_t begin = Tracer::Now();
+    json parsed = ParseJson(body);
+    uint64_t decode = Tracer::Now() - begin;
+    ROPP_PROBE(parse_done, Id, body.size(), decode);
+    if (profile)
+        profile->Decode += decode;
+
+    return parsed;
+}
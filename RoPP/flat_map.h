@@ -0,0 +1,228 @@
+#pragma once
+/*
+* Object storage for RoPP's json: one sorted vector of key/value pairs in place of
+* std::map. Roblox payloads are mostly small objects, and a vector costs one allocation
+* per object instead of one tree node per key. Lookups binary search contiguous keys.
+* Keys stay sorted, so iteration and dump() order match the std::map based nlohmann::json.
+* Needs the full include/json.hpp, include RoPP/json.h rather than this file.
+*/
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace RoPP
+{
+    template <class Key, class T, class IgnoredLess, class Allocator>
+    struct FlatMap : std::vector<std::pair<Key, T>, typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<Key, T>>>
+    {
+        using key_type = Key;
+        using mapped_type = T;
+        using Container = std::vector<std::pair<Key, T>, typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<Key, T>>>;
+        using iterator = typename Container::iterator;
+        using const_iterator = typename Container::const_iterator;
+        using size_type = typename Container::size_type;
+        using value_type = typename Container::value_type;
+        using key_compare = std::less<>;
+
+        template <class KeyType>
+        using Usable = nlohmann::detail::enable_if_t<nlohmann::detail::is_usable_as_key_type<key_compare, key_type, KeyType>::value, int>;
+
+        FlatMap() noexcept(noexcept(Container())) : Container{} {}
+        explicit FlatMap(const Allocator& Alloc) : Container(typename Container::allocator_type(Alloc)) {}
+
+        template <class It>
+        FlatMap(It First, It Last, const Allocator& Alloc = Allocator()) : Container(typename Container::allocator_type(Alloc))
+        {
+            this->insert(First, Last);
+        }
+
+        FlatMap(std::initializer_list<value_type> Init, const Allocator& Alloc = Allocator()) : Container(typename Container::allocator_type(Alloc))
+        {
+            this->insert(Init.begin(), Init.end());
+        }
+
+        std::pair<iterator, bool> emplace(const key_type& Key_, T&& Value)
+        {
+            return this->Emplace(Key_, std::move(Value));
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        std::pair<iterator, bool> emplace(KeyType&& Key_, T&& Value)
+        {
+            return this->Emplace(std::forward<KeyType>(Key_), std::move(Value));
+        }
+
+        T& operator[](const key_type& Key_)
+        {
+            return this->Emplace(Key_, T{}).first->second;
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        T& operator[](KeyType&& Key_)
+        {
+            return this->Emplace(std::forward<KeyType>(Key_), T{}).first->second;
+        }
+
+        const T& operator[](const key_type& Key_) const
+        {
+            return this->at(Key_);
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        const T& operator[](KeyType&& Key_) const
+        {
+            return this->at(Key_);
+        }
+
+        T& at(const key_type& Key_)
+        {
+            return this->Required(Key_)->second;
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        T& at(KeyType&& Key_)
+        {
+            return this->Required(Key_)->second;
+        }
+
+        const T& at(const key_type& Key_) const
+        {
+            return const_cast<FlatMap*>(this)->Required(Key_)->second;
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        const T& at(KeyType&& Key_) const
+        {
+            return const_cast<FlatMap*>(this)->Required(Key_)->second;
+        }
+
+        size_type erase(const key_type& Key_)
+        {
+            return this->EraseKey(Key_);
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        size_type erase(KeyType&& Key_)
+        {
+            return this->EraseKey(Key_);
+        }
+
+        iterator erase(iterator Pos)
+        {
+            return Container::erase(Pos);
+        }
+
+        iterator erase(iterator First, iterator Last)
+        {
+            return Container::erase(First, Last);
+        }
+
+        size_type count(const key_type& Key_) const
+        {
+            return this->find(Key_) != this->end() ? 1 : 0;
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        size_type count(KeyType&& Key_) const
+        {
+            return this->find(Key_) != this->end() ? 1 : 0;
+        }
+
+        iterator find(const key_type& Key_)
+        {
+            return this->Find(Key_);
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        iterator find(KeyType&& Key_)
+        {
+            return this->Find(Key_);
+        }
+
+        const_iterator find(const key_type& Key_) const
+        {
+            return const_cast<FlatMap*>(this)->Find(Key_);
+        }
+
+        template <class KeyType, Usable<KeyType> = 0>
+        const_iterator find(KeyType&& Key_) const
+        {
+            return const_cast<FlatMap*>(this)->Find(Key_);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& Value)
+        {
+            return this->Emplace(std::move(Value.first), std::move(Value.second));
+        }
+
+        std::pair<iterator, bool> insert(const value_type& Value)
+        {
+            return this->Emplace(Value.first, T(Value.second));
+        }
+
+        template <typename InputIt, typename = typename std::enable_if<std::is_convertible<
+            typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>::value>::type>
+        void insert(InputIt First, InputIt Last)
+        {
+            for (; First != Last; ++First)
+                this->Emplace(First->first, T(First->second));
+        }
+
+    private:
+        static constexpr size_type InitialCapacity = 8;
+
+        template <class KeyType>
+        iterator LowerBound(const KeyType& Key_)
+        {
+            return std::lower_bound(this->begin(), this->end(), Key_, [](const value_type& Entry, const KeyType& Wanted) { return key_compare()(Entry.first, Wanted); });
+        }
+
+        template <class KeyType>
+        iterator Find(const KeyType& Key_)
+        {
+            iterator it = this->LowerBound(Key_);
+            return it != this->end() && !key_compare()(Key_, it->first) ? it : this->end();
+        }
+
+        template <class KeyType>
+        iterator Required(const KeyType& Key_)
+        {
+            iterator it = this->Find(Key_);
+            if (it == this->end())
+                throw std::out_of_range("key not found");
+            return it;
+        }
+
+        template <class KeyType>
+        size_type EraseKey(const KeyType& Key_)
+        {
+            iterator it = this->Find(Key_);
+            if (it == this->end())
+                return 0;
+            Container::erase(it);
+            return 1;
+        }
+
+        template <class KeyType>
+        std::pair<iterator, bool> Emplace(KeyType&& Key_, T&& Value)
+        {
+            // documents often list keys in order already, appending skips the search
+            if (this->empty() || key_compare()(this->back().first, Key_))
+            {
+                if (this->capacity() == 0)
+                    this->reserve(InitialCapacity);
+                Container::emplace_back(std::forward<KeyType>(Key_), std::move(Value));
+                return { std::prev(this->end()), true };
+            }
+
+            iterator it = this->LowerBound(Key_);
+            if (!key_compare()(Key_, it->first))
+                return { it, false };
+            return { Container::emplace(it, std::forward<KeyType>(Key_), std::move(Value)), true };
+        }
+    };
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+#include "json.h"
+#include "parallel.h"
+#include "ropp.h"
+
+namespace
+{
+    // 2^4 partitions per worker, partition p of every worker is merged by a single thread
+    constexpr unsigned _m_partitionBits = 4;
+    constexpr size_t _m_partitions = size_t(1) << _m_partitionBits;
+
+    inline uint64_t _m_hash(long Key)
+    {
+        uint64_t h = static_cast<uint64_t>(Key) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 31);
+    }
+
+    // open-addressing user id -> count table with linear probing, id 0 marks an empty slot
+    class _m_CountTable
+    {
+        public:
+            void Add(long Key, uint32_t Count)
+            {
+                if ((this->Used + 1) * 10 > this->Keys.size() * 7)
+                    this->Grow();
+
+                size_t mask = this->Keys.size() - 1;
+                for (size_t slot = _m_hash(Key) & mask;; slot = (slot + 1) & mask)
+                {
+                    if (this->Keys[slot] == Key)
+                    {
+                        this->Counts[slot] += Count;
+                        return;
+                    }
+                    if (this->Keys[slot] == 0)
+                    {
+                        this->Keys[slot] = Key;
+                        this->Counts[slot] = Count;
+                        this->Used++;
+                        return;
+                    }
+                }
+            }
+
+            template <typename Fn> void ForEach(Fn&& Visit) const
+            {
+                for (size_t slot = 0; slot < this->Keys.size(); slot++)
+                    if (this->Keys[slot] != 0)
+                        Visit(this->Keys[slot], this->Counts[slot]);
+            }
+
+            size_t Size() const { return this->Used; }
+
+        private:
+            std::vector<long> Keys;
+            std::vector<uint32_t> Counts;
+            size_t Used = 0;
+
+            void Grow()
+            {
+                std::vector<long> keys(std::max<size_t>(this->Keys.size() * 2, 64));
+                std::vector<uint32_t> counts(keys.size());
+                keys.swap(this->Keys);
+                counts.swap(this->Counts);
+                this->Used = 0;
+                for (size_t slot = 0; slot < keys.size(); slot++)
+                    if (keys[slot] != 0)
+                        this->Add(keys[slot], counts[slot]);
+            }
+    };
+
+    // orders better recommendations first, the top of a priority queue is then the worst kept
+    struct _m_Better
+    {
+        bool operator()(const RoPP::Recommendation& A, const RoPP::Recommendation& B) const
+        {
+            return A.Mutual != B.Mutual ? A.Mutual > B.Mutual : A.UserId < B.UserId;
+        }
+    };
+
+    using _m_TopHeap = std::priority_queue<RoPP::Recommendation, std::vector<RoPP::Recommendation>, _m_Better>;
+
+    void _m_offer(_m_TopHeap& Heap, size_t TopK, const RoPP::Recommendation& Candidate)
+    {
+        if (Heap.size() < TopK)
+            Heap.push(Candidate);
+        else if (_m_Better()(Candidate, Heap.top()))
+        {
+            Heap.pop();
+            Heap.push(Candidate);
+        }
+    }
+}
+
+size_t RoPP::FriendMask::Count() const
+{
+    size_t count = 0;
+    for (uint64_t word : this->Friends)
+        count += __builtin_popcountll(word);
+    return count;
+}
+
+void RoPP::FriendMask::Set(size_t Index, bool Friend)
+{
+    uint64_t bit = uint64_t(1) << (Index % 64);
+    this->Known[Index / 64] |= bit;
+    if (Friend)
+        this->Friends[Index / 64] |= bit;
+    else
+        this->Friends[Index / 64] &= ~bit;
+}
+
+RoPP::FriendList::FriendList(std::vector<long> Ids) : Sorted(std::move(Ids))
+{
+    std::sort(this->Sorted.begin(), this->Sorted.end());
+    this->Sorted.erase(std::unique(this->Sorted.begin(), this->Sorted.end()), this->Sorted.end());
+}
+
+bool RoPP::FriendList::Contains(long UserId) const
+{
+    return std::binary_search(this->Sorted.begin(), this->Sorted.end(), UserId);
+}
+
+/*
+* @brief asks friends/statuses about one batch of distinct ids
+* @return (id, friend) for every well formed entry of the response, empty when the request failed
+*/
+static std::vector<std::pair<long, bool>> _m_statusBatch(long UserId, const long* Ids, size_t Count)
+{
+    std::string url = "https://friends.roblox.com/v1/users/" + std::to_string(UserId) + "/friends/statuses?";
+    for (size_t i = 0; i < Count; i++)
+        url += (i ? "&userIds=" : "userIds=") + std::to_string(Ids[i]);
+
+    std::vector<std::pair<long, bool>> statuses;
+    try
+    {
+        json body = RoPP::FetchJson(url, nullptr, RoPP::Endpoint::FriendStatuses);
+        if (!body.is_object() || !body.contains("data") || !body["data"].is_array())
+            return statuses;
+
+        statuses.reserve(body["data"].size());
+        for (const json& item : body["data"])
+        {
+            // runs on a ParallelFor worker, so entries it cannot read are skipped rather than thrown on
+            if (!item.is_object() || !item.contains("id") || !item["id"].is_number_integer()
+                || !item.contains("status") || !item["status"].is_string())
+                continue;
+            statuses.emplace_back(item["id"].get<long>(), item["status"].get<std::string>() == "Friends");
+        }
+    }
+    catch (const json::exception&)
+    {
+        statuses.clear();
+    }
+    return statuses;
+}
+
+/*
+* @brief checks candidates against UserId's friends in concurrent batches, see friends.h
+* @return mask indexed like Candidates
+*/
+RoPP::FriendMask RoPP::Friends::Statuses(long UserId, const std::vector<long>& Candidates, size_t Concurrency)
+{
+    std::vector<long> distinct(Candidates);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    size_t batches = (distinct.size() + BatchLimit - 1) / BatchLimit;
+    std::vector<std::vector<std::pair<long, bool>>> results(batches);
+    ParallelFor(batches, Concurrency, [&](size_t i, size_t)
+    {
+        size_t begin = i * BatchLimit;
+        results[i] = _m_statusBatch(UserId, distinct.data() + begin, std::min(BatchLimit, distinct.size() - begin));
+    });
+
+    std::unordered_map<long, bool> answered;
+    for (auto& batch : results)
+        answered.insert(batch.begin(), batch.end());
+
+    FriendMask mask(Candidates.size());
+    for (size_t i = 0; i < Candidates.size(); i++)
+    {
+        auto status = answered.find(Candidates[i]);
+        if (status != answered.end())
+            mask.Set(i, status->second);
+    }
+    return mask;
+}
+
+/*
+* @brief answers from a local friend list
+* @return mask indexed like Candidates, every candidate known
+*/
+RoPP::FriendMask RoPP::Friends::Statuses(const FriendList& List, const std::vector<long>& Candidates)
+{
+    FriendMask mask(Candidates.size());
+    for (size_t i = 0; i < Candidates.size(); i++)
+        mask.Set(i, List.Contains(Candidates[i]));
+    return mask;
+}
+
+/*
+* @brief ranks friends of friends by mutual friends, see friends.h
+* @return at most TopK recommendations, best first
+*/
+std::vector<RoPP::Recommendation> RoPP::Friends::Recommend(long UserId, size_t TopK, size_t Concurrency, Cache* CacheLayer)
+{
+    if (TopK == 0)
+        return {};
+
+    User user(UserId);
+    user.SetCache(CacheLayer);
+    FriendList direct = user.GetFriendList();
+    const std::vector<long>& friends = direct.Ids();
+
+    size_t workers = ParallelWorkers(friends.size(), Concurrency);
+    std::vector<std::vector<_m_CountTable>> tables(workers, std::vector<_m_CountTable>(_m_partitions));
+    ParallelFor(friends.size(), workers, [&](size_t i, size_t Worker)
+    {
+        User friendOf(friends[i]);
+        friendOf.SetCache(CacheLayer);
+        FriendList second;
+        try
+        {
+            second = friendOf.GetFriendList();
+        }
+        catch (const json::exception&)
+        {
+            return;
+        }
+        std::vector<_m_CountTable>& local = tables[Worker];
+        for (long candidate : second.Ids())
+            if (candidate != 0)
+                local[_m_hash(candidate) >> (64 - _m_partitionBits)].Add(candidate, 1);
+    });
+
+    std::vector<std::vector<Recommendation>> partitionTops(_m_partitions);
+    ParallelFor(_m_partitions, workers, [&](size_t p, size_t)
+    {
+        size_t largest = 0;
+        for (size_t w = 1; w < workers; w++)
+            if (tables[w][p].Size() > tables[largest][p].Size())
+                largest = w;
+
+        _m_CountTable& merged = tables[largest][p];
+        for (size_t w = 0; w < workers; w++)
+            if (w != largest)
+                tables[w][p].ForEach([&](long Key, uint32_t Count) { merged.Add(Key, Count); });
+
+        _m_TopHeap heap;
+        merged.ForEach([&](long Key, uint32_t Count)
+        {
+            if (Key != UserId && !direct.Contains(Key))
+                _m_offer(heap, TopK, { Key, Count });
+        });
+        for (; !heap.empty(); heap.pop())
+            partitionTops[p].push_back(heap.top());
+    });
+
+    _m_TopHeap heap;
+    for (auto& top : partitionTops)
+        for (const Recommendation& candidate : top)
+            _m_offer(heap, TopK, candidate);
+
+    std::vector<Recommendation> ranked(heap.size());
+    for (size_t i = ranked.size(); i-- > 0; heap.pop())
+        ranked[i] = heap.top();
+    return ranked;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "cache.h"
+
+namespace RoPP
+{
+    /*
+    * Answer to "which of these candidates are friends with X", one bit per candidate in
+    * the order they were asked. Known is clear for candidates whose request failed, so a
+    * clear Friends bit only means "not friends" where Known is set.
+    */
+    struct FriendMask
+    {
+        std::vector<uint64_t> Friends;
+        std::vector<uint64_t> Known;
+        size_t Size = 0;
+
+        explicit FriendMask(size_t Size = 0) : Friends((Size + 63) / 64), Known((Size + 63) / 64), Size(Size) {}
+
+        bool IsFriend(size_t Index) const { return this->Friends[Index / 64] >> (Index % 64) & 1; }
+        bool IsKnown(size_t Index) const { return this->Known[Index / 64] >> (Index % 64) & 1; }
+        size_t Count() const;
+        void Set(size_t Index, bool Friend);
+    };
+
+    // a friend list held locally, kept sorted so lookups are a binary search
+    class FriendList
+    {
+        public:
+            FriendList() = default;
+            explicit FriendList(std::vector<long> Ids);
+
+            bool Contains(long UserId) const;
+            const std::vector<long>& Ids() const { return this->Sorted; }
+            size_t size() const { return this->Sorted.size(); }
+
+        private:
+            std::vector<long> Sorted;
+    };
+
+    struct Recommendation
+    {
+        long UserId = 0;
+        uint32_t Mutual = 0; // friends of the user who are friends with this one
+    };
+
+    class Friends
+    {
+        public:
+            // user ids per friends/statuses request
+            static constexpr size_t BatchLimit = 100;
+
+            /*
+            * Checks which candidates are friends with UserId through friends/statuses. Duplicate
+            * candidates are asked once, the distinct ids go out in full batches of BatchLimit
+            * and Concurrency batches are in flight at a time.
+            */
+            static FriendMask Statuses(long UserId, const std::vector<long>& Candidates, size_t Concurrency = 8);
+
+            // same answer from a friend list already held, without any request
+            static FriendMask Statuses(const FriendList& List, const std::vector<long>& Candidates);
+
+            /*
+            * People UserId may know: every friend of a friend who is not already a friend,
+            * ranked by how many of UserId's friends they share, most first and ties by id.
+            * Friend lists are fetched Concurrency at a time through CacheLayer and each worker
+            * counts into its own partitioned table, so no counter is shared until the merge.
+            */
+            static std::vector<Recommendation> Recommend(long UserId, size_t TopK = 20, size_t Concurrency = 8, Cache* CacheLayer = nullptr);
+    };
+}
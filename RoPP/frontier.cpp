@@ -0,0 +1,526 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+
+#include "frontier.h"
+
+/*
+* On disk layout of a frontier directory:
+*   run-<n>.bin       entries sorted by id, unique within the run (i64 id | u32 depth)
+*   visited-<n>.bin   sorted unique ids already handed out (i64)
+*   head.bin          in-memory head at the last refill or checkpoint
+*   manifest          live runs, visited runs by level and the read offset of the run being consumed
+* Runs are grouped by depth; the lowest depth is consolidated by a k-way merge that drops
+* duplicates and visited ids, then streamed into the head a batch at a time. Merges read at
+* most _m_mergeFanIn runs at once and take several passes when a depth has more.
+* Handed out ids are flushed as a new level 0 visited run; once a level holds
+* _m_visitedFanIn runs they are merged into one run of the next level (a log structured
+* merge), so every id is rewritten about log(ids / BufferLimit) times rather than on every
+* flush, and a lookup pass reads a handful of runs.
+*/
+
+namespace fs = std::filesystem;
+
+static constexpr size_t _m_entrySize = sizeof(int64_t) + sizeof(uint32_t);
+static constexpr size_t _m_mergeFanIn = 64;
+static constexpr size_t _m_visitedFanIn = 8;
+
+class _m_File
+{
+public:
+    _m_File(const std::string& path, const char* mode) : file(std::fopen(path.c_str(), mode))
+    {
+        if (!file)
+            throw std::runtime_error("frontier cannot open " + path);
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+    }
+    ~_m_File()
+    {
+        if (file)
+            std::fclose(file);
+    }
+    _m_File(const _m_File&) = delete;
+    _m_File& operator=(const _m_File&) = delete;
+
+    bool read(RoPP::FrontierEntry& entry)
+    {
+        int64_t id;
+        if (std::fread(&id, sizeof(id), 1, file) != 1 || std::fread(&entry.Depth, sizeof(entry.Depth), 1, file) != 1)
+            return false;
+        entry.Id = static_cast<long>(id);
+        return true;
+    }
+    bool read(long& id)
+    {
+        int64_t value;
+        if (std::fread(&value, sizeof(value), 1, file) != 1)
+            return false;
+        id = static_cast<long>(value);
+        return true;
+    }
+    void write(const RoPP::FrontierEntry& entry)
+    {
+        int64_t id = entry.Id;
+        if (std::fwrite(&id, sizeof(id), 1, file) != 1 || std::fwrite(&entry.Depth, sizeof(entry.Depth), 1, file) != 1)
+            throw std::runtime_error("frontier write failed");
+    }
+    void write(long id)
+    {
+        int64_t value = id;
+        if (std::fwrite(&value, sizeof(value), 1, file) != 1)
+            throw std::runtime_error("frontier write failed");
+    }
+    void seek(uint64_t offset)
+    {
+        std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    }
+    void close()
+    {
+        if (std::fclose(file) != 0)
+            throw std::runtime_error("frontier close failed");
+        file = nullptr;
+    }
+
+private:
+    std::FILE* file;
+};
+
+static long _m_idOf(const RoPP::FrontierEntry& Entry) { return Entry.Id; }
+static long _m_idOf(long Id) { return Id; }
+
+/*
+* Membership test against several sorted id files, asked in ascending id order, so each
+* file is read once front to back.
+*/
+class _m_SortedIds
+{
+public:
+    explicit _m_SortedIds(const std::vector<std::string>& paths)
+    {
+        for (auto& path : paths)
+        {
+            cursors.push_back({ std::make_unique<_m_File>(path, "rb"), 0, false });
+            cursors.back().more = cursors.back().file->read(cursors.back().id);
+        }
+    }
+
+    bool contains(long id)
+    {
+        bool found = false;
+        for (auto& cursor : cursors)
+        {
+            while (cursor.more && cursor.id < id)
+                cursor.more = cursor.file->read(cursor.id);
+            found |= cursor.more && cursor.id == id;
+        }
+        return found;
+    }
+
+private:
+    struct Cursor
+    {
+        std::unique_ptr<_m_File> file;
+        long id;
+        bool more;
+    };
+    std::vector<Cursor> cursors;
+};
+
+/*
+* @brief k-way merges sorted files of T into one, keeping the first record of every id
+* @param Skip ids to leave out, may be nullptr
+* @return records written
+*/
+template <typename T>
+static size_t _m_merge(const std::vector<std::string>& Inputs, const std::string& Output, _m_SortedIds* Skip)
+{
+    std::vector<std::unique_ptr<_m_File>> inputs;
+    std::vector<T> current(Inputs.size());
+    using Cursor = std::pair<long, size_t>;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+    for (size_t i = 0; i < Inputs.size(); i++)
+    {
+        inputs.push_back(std::make_unique<_m_File>(Inputs[i], "rb"));
+        if (inputs[i]->read(current[i]))
+            heap.push({ _m_idOf(current[i]), i });
+    }
+
+    _m_File out(Output, "wb");
+    size_t written = 0;
+    bool first = true;
+    long last = 0;
+    while (!heap.empty())
+    {
+        size_t source = heap.top().second;
+        heap.pop();
+        T record = current[source];
+        if (inputs[source]->read(current[source]))
+            heap.push({ _m_idOf(current[source]), source });
+
+        long id = _m_idOf(record);
+        if (!first && id == last)
+            continue;
+        first = false;
+        last = id;
+        if (Skip && Skip->contains(id))
+            continue;
+
+        out.write(record);
+        written++;
+    }
+    out.close();
+    return written;
+}
+
+/*
+* @brief opens or resumes a frontier stored in a directory
+* @param BufferLimit pushed entries and handed out ids kept in memory before spilling to disk
+* @param HeadSize entries pulled from disk into the in-memory head per refill
+*/
+RoPP::Frontier::Frontier(const std::string& Directory, size_t BufferLimit, size_t HeadSize) : Directory(Directory), BufferLimit(BufferLimit), HeadSize(HeadSize)
+{
+    fs::create_directories(Directory);
+    this->Load();
+}
+
+RoPP::Frontier::~Frontier()
+{
+    try
+    {
+        this->Checkpoint();
+    }
+    catch (const std::exception&)
+    {
+    }
+}
+
+/*
+* @brief adds an id to crawl, duplicates and visited ids are dropped when the runs are merged
+*/
+void RoPP::Frontier::Push(long Id, uint32_t Depth)
+{
+    this->Buffer.push_back({ Id, Depth });
+    if (this->Buffer.size() >= this->BufferLimit)
+        this->Spill();
+}
+
+/*
+* @brief hands out the next ids to crawl, lowest depth first, and marks them visited
+* @return number of entries appended to Batch, 0 once the frontier is exhausted
+*/
+size_t RoPP::Frontier::NextBatch(std::vector<FrontierEntry>& Batch, size_t Max)
+{
+    if (this->Head.empty())
+        this->Refill();
+
+    size_t count = std::min(Max, this->Head.size());
+    for (size_t i = 0; i < count; i++)
+    {
+        Batch.push_back(this->Head.front());
+        this->Visited.push_back(this->Head.front().Id);
+        this->Head.pop_front();
+    }
+
+    if (this->Visited.size() >= this->BufferLimit)
+        this->FlushVisited();
+
+    return count;
+}
+
+/*
+* @brief persists buffered entries, visited ids and the head so a restart resumes from here
+*/
+void RoPP::Frontier::Checkpoint()
+{
+    this->Spill();
+    this->FlushVisited();
+    this->WriteHead();
+    this->WriteManifest();
+}
+
+void RoPP::Frontier::WriteHead()
+{
+    std::string head = this->Directory + "/head.bin";
+    {
+        _m_File out(head + ".tmp", "wb");
+        for (auto& entry : this->Head)
+            out.write(entry);
+        out.close();
+    }
+    fs::rename(head + ".tmp", head);
+}
+
+/*
+* @brief checks whether any entry is left, in memory or on disk
+* @return true when nothing remains to crawl
+*/
+bool RoPP::Frontier::Empty() const
+{
+    return this->Head.empty() && this->Buffer.empty() && this->Runs.empty() && !this->HasActive;
+}
+
+void RoPP::Frontier::Load()
+{
+    std::ifstream manifest(this->Directory + "/manifest");
+    std::string kind;
+    while (manifest >> kind)
+    {
+        if (kind == "next")
+            manifest >> this->NextFile;
+        else if (kind == "run")
+        {
+            Run run;
+            manifest >> run.Depth >> run.File;
+            this->Runs.push_back(run);
+        }
+        else if (kind == "visited")
+        {
+            Run run;
+            manifest >> run.Depth >> run.File;
+            this->VisitedRuns.push_back(run);
+        }
+        else if (kind == "active")
+        {
+            manifest >> this->Active.Depth >> this->Active.File >> this->ActiveOffset;
+            this->HasActive = true;
+        }
+    }
+
+    // directories written before visited runs were tiered keep one visited.bin, adopt it as a run
+    if (this->VisitedRuns.empty() && fs::exists(this->Directory + "/visited.bin"))
+        this->VisitedRuns.push_back({ 0, "visited.bin" });
+
+    if (fs::exists(this->Directory + "/head.bin"))
+    {
+        _m_File in(this->Directory + "/head.bin", "rb");
+        FrontierEntry entry;
+        while (in.read(entry))
+            this->Head.push_back(entry);
+    }
+}
+
+void RoPP::Frontier::WriteManifest()
+{
+    std::string path = this->Directory + "/manifest";
+    {
+        std::ofstream out(path + ".tmp", std::ios::trunc);
+        out << "next " << this->NextFile << "\n";
+        for (auto& run : this->Runs)
+            out << "run " << run.Depth << " " << run.File << "\n";
+        for (auto& run : this->VisitedRuns)
+            out << "visited " << run.Depth << " " << run.File << "\n";
+        if (this->HasActive)
+            out << "active " << this->Active.Depth << " " << this->Active.File << " " << this->ActiveOffset << "\n";
+        if (!out.flush())
+            throw std::runtime_error("frontier manifest write failed");
+    }
+    fs::rename(path + ".tmp", path);
+}
+
+std::string RoPP::Frontier::NewFile(const std::string& Prefix)
+{
+    return Prefix + "-" + std::to_string(this->NextFile++) + ".bin";
+}
+
+/*
+* @brief writes the push buffer out as one sorted run per depth
+*/
+void RoPP::Frontier::Spill()
+{
+    if (this->Buffer.empty())
+        return;
+
+    std::sort(this->Buffer.begin(), this->Buffer.end(), [](const FrontierEntry& a, const FrontierEntry& b)
+    {
+        return a.Depth != b.Depth ? a.Depth < b.Depth : a.Id < b.Id;
+    });
+
+    for (size_t begin = 0; begin < this->Buffer.size();)
+    {
+        uint32_t depth = this->Buffer[begin].Depth;
+        Run run{ depth, this->NewFile("run") };
+        _m_File out(this->Directory + "/" + run.File, "wb");
+
+        size_t end = begin;
+        for (; end < this->Buffer.size() && this->Buffer[end].Depth == depth; end++)
+        {
+            if (end == begin || this->Buffer[end].Id != this->Buffer[end - 1].Id)
+                out.write(this->Buffer[end]);
+        }
+        out.close();
+
+        this->Runs.push_back(run);
+        begin = end;
+    }
+
+    this->Buffer.clear();
+    this->WriteManifest();
+}
+
+/*
+* @brief writes the ids handed out since the last flush as a level 0 visited run, then merges
+* every level that filled up into one run of the next
+*/
+void RoPP::Frontier::FlushVisited()
+{
+    if (this->Visited.empty())
+        return;
+
+    std::sort(this->Visited.begin(), this->Visited.end());
+    this->Visited.erase(std::unique(this->Visited.begin(), this->Visited.end()), this->Visited.end());
+
+    Run flushed{ 0, this->NewFile("visited") };
+    {
+        _m_File out(this->Directory + "/" + flushed.File, "wb");
+        for (long id : this->Visited)
+            out.write(id);
+        out.close();
+    }
+    this->VisitedRuns.push_back(flushed);
+    this->Visited.clear();
+
+    for (uint32_t level = 0;; level++)
+    {
+        std::vector<std::string> inputs;
+        std::vector<Run> remaining;
+        for (auto& run : this->VisitedRuns)
+        {
+            if (run.Depth == level)
+                inputs.push_back(this->Directory + "/" + run.File);
+            else
+                remaining.push_back(run);
+        }
+        if (inputs.size() < _m_visitedFanIn)
+            break;
+
+        Run merged{ level + 1, this->NewFile("visited") };
+        _m_merge<long>(inputs, this->Directory + "/" + merged.File, nullptr);
+        remaining.push_back(merged);
+        this->VisitedRuns = remaining;
+        this->WriteManifest();
+        for (auto& input : inputs)
+            fs::remove(input);
+    }
+    this->WriteManifest();
+}
+
+/*
+* @brief pulls the next HeadSize entries from disk, consolidating the lowest depth when needed
+*/
+void RoPP::Frontier::Refill()
+{
+    this->Spill();
+
+    while (this->Head.size() < this->HeadSize)
+    {
+        if (!this->HasActive)
+        {
+            // ids still in the head are not in a visited run yet, so merge the next level only once it drains
+            if (this->Runs.empty() || !this->Head.empty())
+                break;
+
+            uint32_t depth = std::min_element(this->Runs.begin(), this->Runs.end(), [](const Run& a, const Run& b) { return a.Depth < b.Depth; })->Depth;
+            if (!this->Consolidate(depth))
+                continue;
+        }
+
+        std::string path = this->Directory + "/" + this->Active.File;
+        _m_File in(path, "rb");
+        in.seek(this->ActiveOffset * _m_entrySize);
+
+        FrontierEntry entry;
+        bool more = true;
+        while (this->Head.size() < this->HeadSize && (more = in.read(entry)))
+        {
+            this->Head.push_back(entry);
+            this->ActiveOffset++;
+        }
+
+        if (!more)
+        {
+            in.close();
+            fs::remove(path);
+            this->HasActive = false;
+            this->ActiveOffset = 0;
+        }
+    }
+
+    // the head holds what the manifest's offset moved past, both must land for a restart to resume here
+    this->WriteHead();
+    this->WriteManifest();
+}
+
+/*
+* @brief k-way merges every run of a depth into one run without duplicates or visited ids,
+* in passes of at most _m_mergeFanIn runs
+* @return true when the merged run has entries and became the active run
+*/
+bool RoPP::Frontier::Consolidate(uint32_t Depth)
+{
+    this->FlushVisited();
+
+    std::vector<Run> merging;
+    std::vector<Run> remaining;
+    for (auto& run : this->Runs)
+        (run.Depth == Depth ? merging : remaining).push_back(run);
+
+    auto paths = [this](std::vector<Run>::const_iterator Begin, std::vector<Run>::const_iterator End)
+    {
+        std::vector<std::string> out;
+        for (; Begin != End; ++Begin)
+            out.push_back(this->Directory + "/" + Begin->File);
+        return out;
+    };
+
+    // the intermediate passes only drop duplicates, visited ids go in the last one
+    while (merging.size() > _m_mergeFanIn)
+    {
+        std::vector<Run> next;
+        for (size_t begin = 0; begin < merging.size(); begin += _m_mergeFanIn)
+        {
+            size_t end = std::min(merging.size(), begin + _m_mergeFanIn);
+            if (end - begin == 1)
+            {
+                next.push_back(merging[begin]);
+                continue;
+            }
+            Run pass{ Depth, this->NewFile("run") };
+            _m_merge<FrontierEntry>(paths(merging.begin() + begin, merging.begin() + end), this->Directory + "/" + pass.File, nullptr);
+            next.push_back(pass);
+        }
+
+        this->Runs = remaining;
+        this->Runs.insert(this->Runs.end(), next.begin(), next.end());
+        this->WriteManifest();
+        for (auto& run : merging)
+            if (std::find_if(next.begin(), next.end(), [&](const Run& kept) { return kept.File == run.File; }) == next.end())
+                fs::remove(this->Directory + "/" + run.File);
+        merging = std::move(next);
+    }
+
+    std::vector<std::string> visitedPaths;
+    for (auto& run : this->VisitedRuns)
+        visitedPaths.push_back(this->Directory + "/" + run.File);
+    _m_SortedIds visited(visitedPaths);
+
+    Run merged{ Depth, this->NewFile("run") };
+    size_t written = _m_merge<FrontierEntry>(paths(merging.begin(), merging.end()), this->Directory + "/" + merged.File, &visited);
+
+    this->Runs = remaining;
+    if (written == 0)
+        fs::remove(this->Directory + "/" + merged.File);
+    else
+    {
+        this->Active = merged;
+        this->ActiveOffset = 0;
+        this->HasActive = true;
+    }
+    this->WriteManifest();
+    for (auto& run : merging)
+        fs::remove(this->Directory + "/" + run.File);
+    return written != 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace RoPP
+{
+    struct FrontierEntry
+    {
+        long Id;
+        uint32_t Depth;
+    };
+
+    /*
+    * Breadth first crawl queue too large for memory: pushed ids are spilled to sorted runs on
+    * disk, deduplicated against each other and against every id already handed out, and
+    * handed out lowest depth first. Checkpoint persists everything; without one, a restart
+    * resumes from the last refill of the in-memory head: ids handed out since then are handed
+    * out again, pushes not yet spilled are lost, and ids handed out since the last visited
+    * flush are crawled again if something pushes them anew.
+    */
+    class Frontier
+    {
+        public:
+            Frontier(const std::string& Directory, size_t BufferLimit = 1 << 20, size_t HeadSize = 4096);
+            ~Frontier();
+
+            void Push(long Id, uint32_t Depth = 0);
+            size_t NextBatch(std::vector<FrontierEntry>& Batch, size_t Max);
+            void Checkpoint();
+            bool Empty() const;
+
+        private:
+            struct Run
+            {
+                uint32_t Depth;
+                std::string File;
+            };
+
+            void Load();
+            void Spill();
+            void FlushVisited();
+            void WriteHead();
+            void Refill();
+            bool Consolidate(uint32_t Depth);
+            void WriteManifest();
+            std::string NewFile(const std::string& Prefix);
+
+            std::string Directory;
+            size_t BufferLimit;
+            size_t HeadSize;
+            std::vector<FrontierEntry> Buffer;
+            std::vector<long> Visited;
+            std::deque<FrontierEntry> Head;
+            std::vector<Run> Runs;
+            std::vector<Run> VisitedRuns; // Depth is the merge level
+            Run Active{};
+            uint64_t ActiveOffset = 0;
+            bool HasActive = false;
+            uint64_t NextFile = 0;
+    };
+}
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "json.h"
+#include "log.h"
+#include "parallel.h"
+#include "ropp.h"
+
+static std::string _m_gameKey(long UniverseId)
+{
+    return "ropp:game:" + std::to_string(UniverseId);
+}
+
+static std::string _m_placeKey(long PlaceId)
+{
+    return "ropp:place:" + std::to_string(PlaceId);
+}
+
+/*
+* @brief gets ids from a multi-get endpoint in batches of Game::BatchLimit spread over Concurrency threads
+* @param Url endpoint url up to and including the ids parameter
+* @return one json item per id the endpoint knew, ids of failed batches are left out
+*/
+static std::vector<json> _m_multiget(const std::string& Url, const std::vector<long>& Ids, RoPP::Endpoint Id, size_t Concurrency)
+{
+    const size_t limit = RoPP::Game::BatchLimit;
+    size_t batches = (Ids.size() + limit - 1) / limit;
+    std::vector<std::vector<json>> results(batches);
+    RoPP::ParallelFor(batches, Concurrency, [&](size_t Batch, size_t)
+    {
+        std::string url = Url;
+        size_t end = std::min(Ids.size(), (Batch + 1) * limit);
+        for (size_t i = Batch * limit; i < end; i++)
+            url += (i == Batch * limit ? "" : ",") + std::to_string(Ids[i]);
+
+        try
+        {
+            json body = RoPP::FetchJson(url, nullptr, Id);
+            json* items = body.is_object() && body.contains("data") ? &body["data"] : &body;
+            if (items->is_array())
+                for (json& item : *items)
+                    results[Batch].push_back(std::move(item));
+        }
+        catch (const json::exception&)
+        {
+        }
+    });
+
+    std::vector<json> items;
+    for (auto& batch : results)
+        for (json& item : batch)
+            items.push_back(std::move(item));
+    return items;
+}
+
+/*
+* Field readers that fall back to a default when the field is missing, null or of another
+* type, where json::value would throw type_error.
+*/
+static long _m_long(const json& Item, const char* Key)
+{
+    auto it = Item.find(Key);
+    return it != Item.end() && it->is_number_integer() ? it->get<long>() : 0;
+}
+
+static std::string _m_string(const json& Item, const char* Key)
+{
+    auto it = Item.find(Key);
+    return it != Item.end() && it->is_string() ? it->get<std::string>() : "";
+}
+
+static bool _m_bool(const json& Item, const char* Key)
+{
+    auto it = Item.find(Key);
+    return it != Item.end() && it->is_boolean() && it->get<bool>();
+}
+
+static RoPP::GameDetails _m_gameDetails(const json& Item)
+{
+    RoPP::GameDetails details;
+    details.UniverseId = _m_long(Item, "id");
+    details.RootPlaceId = _m_long(Item, "rootPlaceId");
+    details.Name = _m_string(Item, "name");
+    details.Description = _m_string(Item, "description");
+    auto creator = Item.find("creator");
+    if (creator != Item.end() && creator->is_object())
+    {
+        details.CreatorId = _m_long(*creator, "id");
+        details.CreatorName = _m_string(*creator, "name");
+        details.CreatorType = _m_string(*creator, "type");
+    }
+    details.Playing = _m_long(Item, "playing");
+    details.Visits = _m_long(Item, "visits");
+    details.MaxPlayers = static_cast<int>(_m_long(Item, "maxPlayers"));
+    details.Favorites = _m_long(Item, "favoritedCount");
+    details.Genre = _m_string(Item, "genre");
+    details.Created = _m_string(Item, "created");
+    details.Updated = _m_string(Item, "updated");
+    return details;
+}
+
+static RoPP::PlaceDetails _m_placeDetails(const json& Item)
+{
+    RoPP::PlaceDetails details;
+    details.PlaceId = _m_long(Item, "placeId");
+    details.UniverseId = _m_long(Item, "universeId");
+    details.Name = _m_string(Item, "name");
+    details.Description = _m_string(Item, "description");
+    details.Builder = _m_string(Item, "builder");
+    details.BuilderId = _m_long(Item, "builderId");
+    details.Playable = _m_bool(Item, "isPlayable");
+    return details;
+}
+
+/*
+* @brief answers ids from the cache where possible and batches the rest into multi-get requests
+* @param Key cache key of one id, entries hold that id's json item
+* @return items in the order of Ids, unknown ids and duplicates left out; items that are not
+* objects with an integer IdField are dropped, unreadable cache entries count as misses
+*/
+template <typename Details, typename Convert>
+static std::vector<Details> _m_cachedMultiget(const std::string& Url, const std::vector<long>& Ids, RoPP::Endpoint Id,
+    RoPP::Cache* CacheLayer, size_t Concurrency, std::string (*Key)(long), const char* IdField, Convert Parse)
+{
+    std::unordered_map<long, Details> found;
+    std::unordered_set<long> seen;
+    std::vector<long> missing;
+    for (long id : Ids)
+    {
+        if (!seen.insert(id).second)
+            continue;
+
+        std::string cached;
+        if (CacheLayer && CacheLayer->Get(Key(id), cached))
+        {
+            try
+            {
+                json item = RoPP::ParseJson(cached);
+                if (item.is_object())
+                {
+                    found.emplace(id, Parse(item));
+                    continue;
+                }
+            }
+            catch (const json::exception&)
+            {
+            }
+        }
+        missing.push_back(id);
+    }
+
+    for (const json& item : _m_multiget(Url, missing, Id, Concurrency))
+    {
+        if (!item.is_object() || !item.contains(IdField) || !item[IdField].is_number_integer())
+            continue;
+
+        long id = item[IdField].get<long>();
+        if (CacheLayer)
+            CacheLayer->Put(Key(id), item.dump());
+        found.emplace(id, Parse(item));
+    }
+
+    std::vector<Details> ordered;
+    seen.clear();
+    for (long id : Ids)
+    {
+        auto it = found.find(id);
+        if (it != found.end() && seen.insert(id).second)
+            ordered.push_back(std::move(it->second));
+    }
+    return ordered;
+}
+
+/*
+* @brief gets the details of many universes with games.roblox.com/v1/games, 50 ids per request
+* @param CacheLayer optional cache holding one entry per universe
+* @param Concurrency requests in flight at once
+* @return details in request order, unknown universes left out
+*/
+std::vector<RoPP::GameDetails> RoPP::Game::GetDetails(const std::vector<long>& UniverseIds, Cache* CacheLayer, size_t Concurrency)
+{
+    return _m_cachedMultiget<GameDetails>("https://games.roblox.com/v1/games?universeIds=", UniverseIds, Endpoint::GameDetails,
+        CacheLayer, Concurrency, _m_gameKey, "id", _m_gameDetails);
+}
+
+/*
+* @brief gets the details of many places with games.roblox.com/v1/games/multiget-place-details, 50 ids per request
+* @param CacheLayer optional cache holding one entry per place
+* @return details in request order, unknown places left out
+*/
+std::vector<RoPP::PlaceDetails> RoPP::Game::GetPlaceDetails(const std::vector<long>& PlaceIds, Cache* CacheLayer, size_t Concurrency)
+{
+    return _m_cachedMultiget<PlaceDetails>("https://games.roblox.com/v1/games/multiget-place-details?placeIds=", PlaceIds, Endpoint::PlaceDetails,
+        CacheLayer, Concurrency, _m_placeKey, "placeId", _m_placeDetails);
+}
+
+/*
+* @brief gets the details of the universe
+* @return game details
+*/
+RoPP::GameDetails RoPP::Game::GetDetails()
+{
+    std::vector<GameDetails> details = GetDetails({ this->UniverseId }, this->CacheLayer, 1);
+    if (details.empty())
+        throw std::runtime_error("universe " + std::to_string(this->UniverseId) + " not found");
+    return details.front();
+}
+
+/*
+* @brief gets the live player count of the universe, never cached
+* @return players in game
+*/
+long RoPP::Game::GetPlaying()
+{
+    std::vector<GameDetails> details = GetDetails({ this->UniverseId }, nullptr, 1);
+    if (details.empty())
+        throw std::runtime_error("universe " + std::to_string(this->UniverseId) + " not found");
+    return details.front().Playing;
+}
+
+/*
+* @brief routes this game's detail requests through a cache layer, nullptr disables caching
+*/
+void RoPP::Game::SetCache(Cache* CacheLayer)
+{
+    this->CacheLayer = CacheLayer;
+}
+
+RoPP::PlayerCountPoller::PlayerCountPoller(std::vector<long> UniverseIds, size_t Budget, std::chrono::milliseconds Period, Callback OnDelta)
+    : Budget(std::max<size_t>(Budget, 1)), Period(Period), OnDelta(std::move(OnDelta))
+{
+    for (long id : UniverseIds)
+        if (this->WatchedSet.insert(id).second)
+            this->Watched.push_back(id);
+}
+
+RoPP::PlayerCountPoller::~PlayerCountPoller()
+{
+    this->Stop();
+}
+
+void RoPP::PlayerCountPoller::Watch(long UniverseId)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (this->WatchedSet.insert(UniverseId).second)
+        this->Watched.push_back(UniverseId);
+}
+
+void RoPP::PlayerCountPoller::Unwatch(long UniverseId)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (!this->WatchedSet.erase(UniverseId))
+        return;
+
+    auto it = std::find(this->Watched.begin(), this->Watched.end(), UniverseId);
+    size_t index = it - this->Watched.begin();
+    this->Watched.erase(it);
+    this->Playing.erase(UniverseId);
+    if (index < this->Cursor)
+        this->Cursor--;
+    if (this->Cursor >= this->Watched.size())
+        this->Cursor = 0;
+}
+
+/*
+* @brief gets how many periods one refresh of the whole watch set takes at this budget
+*/
+size_t RoPP::PlayerCountPoller::SweepPeriods()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    size_t requests = (this->Watched.size() + Game::BatchLimit - 1) / Game::BatchLimit;
+    return (requests + this->Budget - 1) / this->Budget;
+}
+
+/*
+* @brief runs one round: refreshes the next Budget batches of the watch set
+* @return counts that changed since they were last seen, also passed to the callback
+*/
+std::vector<RoPP::PlayerCountDelta> RoPP::PlayerCountPoller::Poll()
+{
+    std::vector<long> slice;
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        size_t take = std::min(this->Watched.size(), this->Budget * Game::BatchLimit);
+        for (size_t i = 0; i < take; i++)
+            slice.push_back(this->Watched[(this->Cursor + i) % this->Watched.size()]);
+        if (!this->Watched.empty())
+            this->Cursor = (this->Cursor + take) % this->Watched.size();
+    }
+    if (slice.empty())
+        return {};
+
+    std::vector<GameDetails> details = Game::GetDetails(slice, nullptr, std::min<size_t>(this->Budget, 8));
+
+    std::vector<PlayerCountDelta> deltas;
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        for (const GameDetails& game : details)
+        {
+            auto known = this->Playing.find(game.UniverseId);
+            if (known != this->Playing.end() && known->second == game.Playing)
+                continue;
+            // skip universes unwatched while the round was in flight
+            if (known == this->Playing.end() && !this->WatchedSet.count(game.UniverseId))
+                continue;
+
+            deltas.push_back({ game.UniverseId, known == this->Playing.end() ? -1 : known->second, game.Playing });
+            this->Playing[game.UniverseId] = game.Playing;
+        }
+    }
+
+    if (Topic<PlayerCountDelta>* events = this->Events.load())
+        for (const PlayerCountDelta& delta : deltas)
+            events->Publish(delta);
+    if (!deltas.empty() && this->OnDelta)
+        this->OnDelta(deltas);
+    return deltas;
+}
+
+/*
+* @brief also publishes deltas to a topic, nullptr stops publishing
+*/
+void RoPP::PlayerCountPoller::PublishTo(Topic<PlayerCountDelta>* Events)
+{
+    this->Events = Events;
+}
+
+/*
+* @brief polls once per period on a background thread until Stop; a round that throws, in
+* the request or in the callback, is logged as PollFailed and the next round goes ahead
+*/
+void RoPP::PlayerCountPoller::Start()
+{
+    std::lock_guard<std::mutex> lock(this->RunMutex);
+    if (this->Running)
+        return;
+    this->Running = true;
+    this->Runner = std::thread([this]
+    {
+        std::unique_lock<std::mutex> lock(this->RunMutex);
+        while (this->Running)
+        {
+            auto next = std::chrono::steady_clock::now() + this->Period;
+            lock.unlock();
+            try
+            {
+                this->Poll();
+            }
+            catch (const std::exception&)
+            {
+                ROPP_LOG(LogLevel::Error, LogEvent::PollFailed, Endpoint::GameDetails, 0, 0, 0);
+            }
+            lock.lock();
+            this->Wake.wait_until(lock, next, [this] { return !this->Running; });
+        }
+    });
+}
+
+void RoPP::PlayerCountPoller::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->RunMutex);
+        if (!this->Running)
+            return;
+        this->Running = false;
+    }
+    this->Wake.notify_all();
+    this->Runner.join();
+}
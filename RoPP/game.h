@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "bus.h"
+#include "cache.h"
+
+namespace RoPP
+{
+    struct GameDetails
+    {
+        long UniverseId = 0;
+        long RootPlaceId = 0;
+        std::string Name;
+        std::string Description;
+        long CreatorId = 0;
+        std::string CreatorName;
+        std::string CreatorType;
+        long Playing = 0;
+        long Visits = 0;
+        int MaxPlayers = 0;
+        long Favorites = 0;
+        std::string Genre;
+        std::string Created;
+        std::string Updated;
+    };
+
+    struct PlaceDetails
+    {
+        long PlaceId = 0;
+        long UniverseId = 0;
+        std::string Name;
+        std::string Description;
+        std::string Builder;
+        long BuilderId = 0;
+        bool Playable = false;
+    };
+
+    class Game
+    {
+        public:
+            // ids per request the multi-get endpoints accept
+            static constexpr size_t BatchLimit = 50;
+
+            GameDetails GetDetails();
+            long GetPlaying();
+            void SetCache(Cache* CacheLayer);
+
+            static std::vector<GameDetails> GetDetails(const std::vector<long>& UniverseIds, Cache* CacheLayer = nullptr, size_t Concurrency = 4);
+            static std::vector<PlaceDetails> GetPlaceDetails(const std::vector<long>& PlaceIds, Cache* CacheLayer = nullptr, size_t Concurrency = 4);
+
+            Game(long UniverseId)
+            {
+                this->UniverseId = UniverseId;
+            }
+
+        private:
+            long UniverseId;
+            Cache* CacheLayer = nullptr;
+    };
+
+    struct PlayerCountDelta
+    {
+        long UniverseId;
+        long Previous; // -1 the first time a universe is seen
+        long Playing;
+    };
+
+    /*
+    * Keeps playing counts of a watch set fresh within a fixed request budget. Every Period
+    * the poller spends at most Budget multi-get requests, continuing round robin from where
+    * the previous round stopped. A full sweep takes ceil(ids / 50 / Budget) periods. Only
+    * counts that changed are reported:
+    *   RoPP::PlayerCountPoller poller(ids, 10, std::chrono::seconds(5), [](auto& deltas) { ... });
+    *   poller.Start();
+    * PublishTo also puts every delta on an event bus topic, keyed by universe id there so
+    * slow subscribers can coalesce.
+    */
+    class PlayerCountPoller
+    {
+        public:
+            using Callback = std::function<void(const std::vector<PlayerCountDelta>&)>;
+
+            PlayerCountPoller(std::vector<long> UniverseIds, size_t Budget, std::chrono::milliseconds Period, Callback OnDelta);
+            ~PlayerCountPoller();
+
+            void Watch(long UniverseId);
+            void Unwatch(long UniverseId);
+            std::vector<PlayerCountDelta> Poll();
+            void Start();
+            void Stop();
+            size_t SweepPeriods();
+            void PublishTo(Topic<PlayerCountDelta>* Events);
+
+        private:
+            std::mutex Mutex;
+            std::vector<long> Watched; // round robin order
+            std::unordered_set<long> WatchedSet;
+            std::unordered_map<long, long> Playing;
+            size_t Cursor = 0;
+            size_t Budget;
+            std::chrono::milliseconds Period;
+            Callback OnDelta;
+            std::atomic<Topic<PlayerCountDelta>*> Events{ nullptr };
+
+            std::mutex RunMutex;
+            std::condition_variable Wake;
+            std::thread Runner;
+            bool Running = false;
+    };
+}
@@ -0,0 +1,527 @@
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include "graph.h"
+
+struct RoPP::GraphStore::Base
+{
+    std::vector<long> Vertices;   // sorted
+    std::vector<size_t> Offsets;  // Vertices.size() + 1
+    std::vector<long> Targets;    // sorted within each vertex
+
+    std::pair<const long*, const long*> Edges(long Vertex) const
+    {
+        auto it = std::lower_bound(this->Vertices.begin(), this->Vertices.end(), Vertex);
+        if (it == this->Vertices.end() || *it != Vertex)
+            return { nullptr, nullptr };
+        size_t index = it - this->Vertices.begin();
+        return { this->Targets.data() + this->Offsets[index], this->Targets.data() + this->Offsets[index + 1] };
+    }
+};
+
+// edges of one vertex added and removed since the base was built, Deletes is a subset of the base
+struct RoPP::GraphStore::Delta
+{
+    std::vector<long> Inserts;
+    std::vector<long> Deletes;
+
+    size_t Size() const { return this->Inserts.size() + this->Deletes.size(); }
+};
+
+// immutable once published, a commit copies only the buckets it touches
+struct RoPP::GraphStore::Bucket
+{
+    std::vector<std::pair<long, std::shared_ptr<const Delta>>> Entries; // sorted by vertex
+};
+
+struct RoPP::GraphStore::Version
+{
+    const Base* Edges = nullptr;
+    std::array<const Bucket*, Buckets> Parts{};
+    size_t DeltaEdges = 0;
+
+    static size_t BucketOf(long Vertex)
+    {
+        return (static_cast<uint64_t>(Vertex) * 0x9E3779B97F4A7C15ull) >> 56;
+    }
+
+    const Delta* Find(long Vertex) const
+    {
+        const Bucket* part = this->Parts[BucketOf(Vertex)];
+        if (!part)
+            return nullptr;
+        auto it = std::lower_bound(part->Entries.begin(), part->Entries.end(), Vertex, [](const auto& Entry, long Key) { return Entry.first < Key; });
+        return it != part->Entries.end() && it->first == Vertex ? it->second.get() : nullptr;
+    }
+
+    bool HasEdge(long From, long To) const
+    {
+        auto edges = this->Edges->Edges(From);
+        const Delta* delta = this->Find(From);
+        if (std::binary_search(edges.first, edges.second, To))
+            return !delta || !std::binary_search(delta->Deletes.begin(), delta->Deletes.end(), To);
+        return delta && std::binary_search(delta->Inserts.begin(), delta->Inserts.end(), To);
+    }
+
+    size_t Degree(long Vertex) const
+    {
+        auto edges = this->Edges->Edges(Vertex);
+        const Delta* delta = this->Find(Vertex);
+        size_t degree = edges.second - edges.first;
+        return delta ? degree - delta->Deletes.size() + delta->Inserts.size() : degree;
+    }
+
+    std::vector<long> Neighbors(long Vertex) const
+    {
+        auto edges = this->Edges->Edges(Vertex);
+        const Delta* delta = this->Find(Vertex);
+        if (!delta)
+            return std::vector<long>(edges.first, edges.second);
+
+        std::vector<long> kept;
+        kept.reserve(edges.second - edges.first);
+        std::set_difference(edges.first, edges.second, delta->Deletes.begin(), delta->Deletes.end(), std::back_inserter(kept));
+        std::vector<long> neighbors;
+        neighbors.reserve(kept.size() + delta->Inserts.size());
+        std::merge(kept.begin(), kept.end(), delta->Inserts.begin(), delta->Inserts.end(), std::back_inserter(neighbors));
+        return neighbors;
+    }
+};
+
+RoPP::GraphStore::GraphStore() : GraphStore(std::vector<std::pair<long, std::vector<long>>>{})
+{
+}
+
+RoPP::GraphStore::GraphStore(const std::vector<std::pair<long, std::vector<long>>>& Adjacency)
+{
+    std::vector<std::pair<long, std::vector<long>>> lists(Adjacency);
+    std::sort(lists.begin(), lists.end(), [](const auto& A, const auto& B) { return A.first < B.first; });
+
+    Base* base = new Base();
+    base->Offsets.push_back(0);
+    for (size_t i = 0; i < lists.size(); i++)
+    {
+        // a vertex listed twice keeps the union of its lists
+        std::vector<long>& targets = lists[i].second;
+        while (i + 1 < lists.size() && lists[i + 1].first == lists[i].first)
+        {
+            targets.insert(targets.end(), lists[i + 1].second.begin(), lists[i + 1].second.end());
+            i++;
+        }
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+        if (targets.empty())
+            continue;
+
+        base->Vertices.push_back(lists[i].first);
+        base->Targets.insert(base->Targets.end(), targets.begin(), targets.end());
+        base->Offsets.push_back(base->Targets.size());
+    }
+
+    Version* version = new Version();
+    version->Edges = base;
+    this->Current.store(version);
+}
+
+RoPP::GraphStore::~GraphStore()
+{
+    this->StopCompactor();
+
+    const Version* version = this->Current.load();
+    for (const Bucket* part : version->Parts)
+        delete part;
+    delete version->Edges;
+    delete version;
+    for (Retired& retired : this->Limbo)
+        retired.Free();
+}
+
+/*
+* @brief pins the current version for lock free reads until the snapshot is destroyed; with
+* every reader slot taken the pin goes to the overflow list instead
+* @return snapshot of every edge committed so far
+*/
+RoPP::GraphStore::Snapshot RoPP::GraphStore::Read() const
+{
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % Slots;
+    for (size_t i = 0; i < Slots; i++)
+    {
+        size_t slot = (start + i) % Slots;
+        uint64_t idle = Idle;
+        // the pin must be visible before the version is loaded, both are sequentially consistent
+        if (this->Readers[slot].Epoch.compare_exchange_strong(idle, this->Epoch.load()))
+            return Snapshot(this, this->Current.load(), slot);
+    }
+
+    // Reclaim reads the list under the same mutex, so a version loaded here is never freed under us
+    std::lock_guard<std::mutex> lock(this->OverflowMutex);
+    uint64_t pin = this->Epoch.load();
+    this->Overflow.insert(pin);
+    return Snapshot(this, this->Current.load(), Slots, pin);
+}
+
+RoPP::GraphStore::Snapshot::Snapshot(Snapshot&& Other) noexcept : Store(Other.Store), View(Other.View), Slot(Other.Slot), Pin(Other.Pin)
+{
+    Other.Store = nullptr;
+}
+
+RoPP::GraphStore::Snapshot::~Snapshot()
+{
+    if (!this->Store)
+        return;
+
+    if (this->Slot < Slots)
+        this->Store->Readers[this->Slot].Epoch.store(Idle, std::memory_order_release);
+    else
+    {
+        std::lock_guard<std::mutex> lock(this->Store->OverflowMutex);
+        this->Store->Overflow.erase(this->Store->Overflow.find(this->Pin));
+    }
+}
+
+bool RoPP::GraphStore::Snapshot::HasEdge(long From, long To) const
+{
+    return this->View->HasEdge(From, To);
+}
+
+size_t RoPP::GraphStore::Snapshot::Degree(long Vertex) const
+{
+    return this->View->Degree(Vertex);
+}
+
+std::vector<long> RoPP::GraphStore::Snapshot::Neighbors(long Vertex) const
+{
+    return this->View->Neighbors(Vertex);
+}
+
+void RoPP::GraphStore::Snapshot::ForEachNeighbor(long Vertex, const std::function<void(long)>& Visit) const
+{
+    auto edges = this->View->Edges->Edges(Vertex);
+    const Delta* delta = this->View->Find(Vertex);
+    if (!delta)
+    {
+        std::for_each(edges.first, edges.second, Visit);
+        return;
+    }
+
+    auto deleted = delta->Deletes.begin();
+    for (const long* edge = edges.first; edge != edges.second; edge++)
+    {
+        while (deleted != delta->Deletes.end() && *deleted < *edge)
+            deleted++;
+        if (deleted == delta->Deletes.end() || *deleted != *edge)
+            Visit(*edge);
+    }
+    std::for_each(delta->Inserts.begin(), delta->Inserts.end(), Visit);
+}
+
+/*
+* @brief applies a batch of updates atomically, readers see all of it or none
+*/
+void RoPP::GraphStore::Apply(const std::vector<EdgeUpdate>& Updates)
+{
+    std::lock_guard<std::mutex> lock(this->WriteMutex);
+    this->Commit(Updates);
+}
+
+void RoPP::GraphStore::AddEdge(long From, long To)
+{
+    this->Apply({ { From, To, false } });
+}
+
+void RoPP::GraphStore::RemoveEdge(long From, long To)
+{
+    this->Apply({ { From, To, true } });
+}
+
+/*
+* @brief sets a vertex's whole neighbor list, e.g. a refreshed friend list, committing only the diff
+*/
+void RoPP::GraphStore::ReplaceNeighbors(long Vertex, std::vector<long> Neighbors)
+{
+    std::sort(Neighbors.begin(), Neighbors.end());
+    Neighbors.erase(std::unique(Neighbors.begin(), Neighbors.end()), Neighbors.end());
+
+    std::lock_guard<std::mutex> lock(this->WriteMutex);
+    // writers hold the mutex, so the current version cannot be retired under us
+    std::vector<long> existing = this->Current.load()->Neighbors(Vertex);
+
+    std::vector<EdgeUpdate> updates;
+    auto before = existing.begin();
+    auto after = Neighbors.begin();
+    while (before != existing.end() || after != Neighbors.end())
+    {
+        if (after == Neighbors.end() || (before != existing.end() && *before < *after))
+            updates.push_back({ Vertex, *before++, true });
+        else if (before == existing.end() || *after < *before)
+            updates.push_back({ Vertex, *after++, false });
+        else
+        {
+            before++;
+            after++;
+        }
+    }
+    if (!updates.empty())
+        this->Commit(updates);
+}
+
+void RoPP::GraphStore::Commit(const std::vector<EdgeUpdate>& Updates)
+{
+    if (this->Compacting)
+        this->CompactLog.insert(this->CompactLog.end(), Updates.begin(), Updates.end());
+
+    Version* next = new Version(*this->Current.load());
+    std::vector<const Bucket*> replaced;
+    Stage(next, Updates, replaced);
+    for (const Bucket* part : replaced)
+        this->Retire([part] { delete part; });
+    this->Publish(next);
+
+    if (this->DeltaLimit && next->DeltaEdges >= this->DeltaLimit && !this->Compacting)
+        this->CompactorWake.notify_one();
+}
+
+/*
+* @brief applies Updates to an unpublished copy of a version, copying each touched delta and bucket once
+* @param Replaced receives the buckets the copy no longer references
+*/
+void RoPP::GraphStore::Stage(Version* Next, const std::vector<EdgeUpdate>& Updates, std::vector<const Bucket*>& Replaced)
+{
+    std::unordered_map<long, std::shared_ptr<Delta>> touched;
+    for (const EdgeUpdate& update : Updates)
+    {
+        std::shared_ptr<Delta>& delta = touched[update.From];
+        if (!delta)
+        {
+            const Delta* existing = Next->Find(update.From);
+            delta = existing ? std::make_shared<Delta>(*existing) : std::make_shared<Delta>();
+        }
+
+        auto edges = Next->Edges->Edges(update.From);
+        bool inBase = std::binary_search(edges.first, edges.second, update.To);
+        // an insert of a base edge undoes its delete, a delete of a buffered insert undoes the insert
+        std::vector<long>& list = inBase ? delta->Deletes : delta->Inserts;
+        auto at = std::lower_bound(list.begin(), list.end(), update.To);
+        bool present = at != list.end() && *at == update.To;
+        bool wanted = inBase ? update.Remove : !update.Remove;
+        if (wanted && !present)
+            list.insert(at, update.To);
+        else if (!wanted && present)
+            list.erase(at);
+    }
+
+    std::unordered_map<size_t, Bucket*> copies;
+    for (auto& [vertex, delta] : touched)
+    {
+        size_t index = Version::BucketOf(vertex);
+        Bucket*& copy = copies[index];
+        if (!copy)
+        {
+            const Bucket* existing = Next->Parts[index];
+            copy = existing ? new Bucket(*existing) : new Bucket();
+            if (existing)
+                Replaced.push_back(existing);
+        }
+
+        auto& entries = copy->Entries;
+        auto at = std::lower_bound(entries.begin(), entries.end(), vertex, [](const auto& Entry, long Key) { return Entry.first < Key; });
+        bool present = at != entries.end() && at->first == vertex;
+        if (present)
+            Next->DeltaEdges -= at->second->Size();
+        Next->DeltaEdges += delta->Size();
+
+        if (delta->Size() == 0)
+        {
+            if (present)
+                entries.erase(at);
+        }
+        else if (present)
+            at->second = std::move(delta);
+        else
+            entries.insert(at, { vertex, std::move(delta) });
+    }
+
+    for (auto& [index, copy] : copies)
+    {
+        if (copy->Entries.empty())
+        {
+            delete copy;
+            copy = nullptr;
+        }
+        Next->Parts[index] = copy;
+    }
+}
+
+/*
+* @brief makes Next the version new snapshots see and retires the one it replaces
+*/
+void RoPP::GraphStore::Publish(Version* Next)
+{
+    const Version* previous = this->Current.exchange(Next);
+    this->Retire([previous] { delete previous; });
+    this->Epoch.fetch_add(1);
+    this->Reclaim();
+}
+
+/*
+* @brief queues memory unlinked from the current version, freed once no snapshot can reach it
+*/
+void RoPP::GraphStore::Retire(std::function<void()> Free)
+{
+    this->Limbo.push_back({ this->Epoch.load(), std::move(Free) });
+}
+
+/*
+* @brief frees retired memory older than every pinned snapshot
+*/
+void RoPP::GraphStore::Reclaim()
+{
+    uint64_t oldest = Idle;
+    for (const ReaderSlot& reader : this->Readers)
+        oldest = std::min(oldest, reader.Epoch.load());
+    {
+        std::lock_guard<std::mutex> lock(this->OverflowMutex);
+        if (!this->Overflow.empty())
+            oldest = std::min(oldest, *this->Overflow.begin());
+    }
+
+    auto kept = std::partition(this->Limbo.begin(), this->Limbo.end(), [oldest](const Retired& Entry) { return Entry.Epoch >= oldest; });
+    for (auto it = kept; it != this->Limbo.end(); it++)
+        it->Free();
+    this->Limbo.erase(kept, this->Limbo.end());
+}
+
+/*
+* @brief merges a version's base and delta buffers into a fresh base
+*/
+RoPP::GraphStore::Base* RoPP::GraphStore::Rebuild(const Version* View)
+{
+    std::vector<long> vertices(View->Edges->Vertices);
+    for (const Bucket* part : View->Parts)
+        if (part)
+            for (const auto& entry : part->Entries)
+                vertices.push_back(entry.first);
+    std::sort(vertices.begin(), vertices.end());
+    vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+    Base* base = new Base();
+    base->Targets.reserve(View->Edges->Targets.size() + View->DeltaEdges);
+    base->Offsets.push_back(0);
+    for (long vertex : vertices)
+    {
+        size_t before = base->Targets.size();
+        std::vector<long> neighbors = View->Neighbors(vertex);
+        if (neighbors.empty())
+            continue;
+        base->Targets.insert(base->Targets.end(), neighbors.begin(), neighbors.end());
+        base->Vertices.push_back(vertex);
+        base->Offsets.push_back(before + neighbors.size());
+    }
+    return base;
+}
+
+/*
+* @brief folds the delta buffers into a new base, writers keep going while it is built
+*/
+void RoPP::GraphStore::Compact()
+{
+    Base* base;
+    {
+        std::unique_lock<std::mutex> lock(this->WriteMutex);
+        if (this->Compacting || this->Current.load()->DeltaEdges == 0)
+            return;
+        this->Compacting = true;
+        this->CompactLog.clear();
+
+        Snapshot view = this->Read();
+        lock.unlock();
+        base = Rebuild(view.View);
+    }
+
+    std::lock_guard<std::mutex> lock(this->WriteMutex);
+    const Version* current = this->Current.load();
+    Version* next = new Version();
+    next->Edges = base;
+    // replay what was committed during the rebuild on top of the new base
+    std::vector<const Bucket*> unused;
+    Stage(next, this->CompactLog, unused);
+
+    for (const Bucket* part : current->Parts)
+        if (part)
+            this->Retire([part] { delete part; });
+    const Base* previous = current->Edges;
+    this->Retire([previous] { delete previous; });
+    this->Publish(next);
+
+    this->CompactLog.clear();
+    this->CompactLog.shrink_to_fit();
+    this->Compacting = false;
+    this->Compactions++;
+}
+
+/*
+* @brief compacts in the background whenever the delta buffers hold DeltaLimit edges, checked every Period and on commit
+*/
+void RoPP::GraphStore::StartCompactor(size_t DeltaLimit, std::chrono::milliseconds Period)
+{
+    std::lock_guard<std::mutex> lock(this->CompactorMutex);
+    if (this->Compactor.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> write(this->WriteMutex);
+        this->DeltaLimit = std::max<size_t>(DeltaLimit, 1);
+    }
+    this->CompactorPeriod = Period;
+    this->CompactorStop = false;
+    this->Compactor = std::thread([this] { this->CompactorLoop(); });
+}
+
+void RoPP::GraphStore::StopCompactor()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->CompactorMutex);
+        if (!this->Compactor.joinable())
+            return;
+        this->CompactorStop = true;
+    }
+    this->CompactorWake.notify_all();
+    this->Compactor.join();
+
+    std::lock_guard<std::mutex> write(this->WriteMutex);
+    this->DeltaLimit = 0;
+}
+
+void RoPP::GraphStore::CompactorLoop()
+{
+    std::unique_lock<std::mutex> lock(this->CompactorMutex);
+    while (!this->CompactorStop)
+    {
+        this->CompactorWake.wait_for(lock, this->CompactorPeriod);
+        if (this->CompactorStop)
+            break;
+
+        lock.unlock();
+        size_t deltas;
+        {
+            std::lock_guard<std::mutex> write(this->WriteMutex);
+            deltas = this->Current.load()->DeltaEdges;
+        }
+        if (deltas >= this->DeltaLimit)
+            this->Compact();
+        lock.lock();
+    }
+}
+
+RoPP::GraphStats RoPP::GraphStore::Stats()
+{
+    std::lock_guard<std::mutex> lock(this->WriteMutex);
+    const Version* current = this->Current.load();
+    GraphStats stats;
+    stats.Vertices = current->Edges->Vertices.size();
+    stats.BaseEdges = current->Edges->Targets.size();
+    stats.DeltaEdges = current->DeltaEdges;
+    stats.Compactions = this->Compactions;
+    stats.Retired = this->Limbo.size();
+    return stats;
+}
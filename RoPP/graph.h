@@ -0,0 +1,143 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace RoPP
+{
+    struct EdgeUpdate
+    {
+        long From;
+        long To;
+        bool Remove = false;
+    };
+
+    struct GraphStats
+    {
+        size_t Vertices = 0;     // in the base
+        size_t BaseEdges = 0;
+        size_t DeltaEdges = 0;   // inserts plus deletes buffered over the base
+        uint64_t Compactions = 0;
+        size_t Retired = 0;      // versions and buffers waiting for readers to move on
+    };
+
+    /*
+    * Directed adjacency store for friend graphs that change a little at a time. An
+    * immutable CSR base holds the bulk of the edges; per-vertex insert and delete buffers
+    * layered over it take the updates, so a refreshed friend list costs its diff rather
+    * than a rebuild. Compact, by hand or from the background compactor, folds the buffers
+    * into a new base while writes continue.
+    *
+    * Readers never lock. A Snapshot pins the current version and sees exactly the edges
+    * committed before it was taken; retired versions, buffers and bases are only freed
+    * once every snapshot that could still see them has been released (epoch based
+    * reclamation). The first Slots concurrent snapshots pin a reader slot without locking,
+    * any more pin through a mutex guarded overflow list. Writers are serialised among
+    * themselves.
+    *   RoPP::GraphStore graph;
+    *   graph.ReplaceNeighbors(user, friendIds);
+    *   RoPP::GraphStore::Snapshot view = graph.Read();
+    *   for (long id : view.Neighbors(user)) ...
+    */
+    class GraphStore
+    {
+        struct Base;
+        struct Delta;
+        struct Bucket;
+        struct Version;
+
+        public:
+            class Snapshot
+            {
+                public:
+                    Snapshot(Snapshot&& Other) noexcept;
+                    Snapshot(const Snapshot&) = delete;
+                    Snapshot& operator=(const Snapshot&) = delete;
+                    ~Snapshot();
+
+                    bool HasEdge(long From, long To) const;
+                    size_t Degree(long Vertex) const;
+                    std::vector<long> Neighbors(long Vertex) const;   // sorted
+                    void ForEachNeighbor(long Vertex, const std::function<void(long)>& Visit) const;
+
+                private:
+                    friend class GraphStore;
+                    Snapshot(const GraphStore* Store, const Version* View, size_t Slot, uint64_t Pin = 0)
+                        : Store(Store), View(View), Slot(Slot), Pin(Pin) {}
+
+                    const GraphStore* Store;
+                    const Version* View;
+                    size_t Slot; // Slots when pinned in the overflow list
+                    uint64_t Pin;
+            };
+
+            GraphStore();
+            explicit GraphStore(const std::vector<std::pair<long, std::vector<long>>>& Adjacency);
+            ~GraphStore();
+
+            Snapshot Read() const;
+
+            void Apply(const std::vector<EdgeUpdate>& Updates);
+            void AddEdge(long From, long To);
+            void RemoveEdge(long From, long To);
+            void ReplaceNeighbors(long Vertex, std::vector<long> Neighbors);
+
+            void Compact();
+            void StartCompactor(size_t DeltaLimit = 1 << 16, std::chrono::milliseconds Period = std::chrono::seconds(1));
+            void StopCompactor();
+
+            GraphStats Stats();
+
+        private:
+            static constexpr size_t Buckets = 256;
+            static constexpr size_t Slots = 128;
+            static constexpr uint64_t Idle = UINT64_MAX;
+
+            struct alignas(64) ReaderSlot
+            {
+                std::atomic<uint64_t> Epoch{ Idle };
+            };
+
+            struct Retired
+            {
+                uint64_t Epoch;
+                std::function<void()> Free;
+            };
+
+            static void Stage(Version* Next, const std::vector<EdgeUpdate>& Updates, std::vector<const Bucket*>& Replaced);
+            static Base* Rebuild(const Version* View);
+
+            void Commit(const std::vector<EdgeUpdate>& Updates);
+            void Publish(Version* Next);
+            void Retire(std::function<void()> Free);
+            void Reclaim();
+            void CompactorLoop();
+
+            std::atomic<const Version*> Current{ nullptr };
+            mutable std::array<ReaderSlot, Slots> Readers;
+            mutable std::mutex OverflowMutex;
+            mutable std::multiset<uint64_t> Overflow; // epochs of snapshots that found every slot taken
+            std::atomic<uint64_t> Epoch{ 1 };
+
+            std::mutex WriteMutex;
+            std::vector<Retired> Limbo;
+            bool Compacting = false;
+            std::vector<EdgeUpdate> CompactLog; // updates committed while a compaction builds its base
+            uint64_t Compactions = 0;
+
+            std::mutex CompactorMutex;
+            std::condition_variable CompactorWake;
+            std::thread Compactor;
+            bool CompactorStop = false;
+            size_t DeltaLimit = 0;
+            std::chrono::milliseconds CompactorPeriod{ 1000 };
+    };
+}
@@ -0,0 +1,200 @@
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+
+#include "json.h"
+#include "ropp.h"
+
+static const char* _m_itemType(RoPP::ItemType Type)
+{
+    switch (Type)
+    {
+    case RoPP::ItemType::GamePass: return "GamePass";
+    case RoPP::ItemType::Badge: return "Badge";
+    case RoPP::ItemType::Bundle: return "Bundle";
+    default: return "Asset";
+    }
+}
+
+// the v2 inventory endpoint only takes these page sizes, others are rounded up to the next one
+static size_t _m_pageSize(size_t Requested)
+{
+    for (size_t size : { 10, 25, 50 })
+        if (Requested <= size)
+            return size;
+    return 100;
+}
+
+// page cursors are opaque and may hold characters that need escaping in a query
+static std::string _m_escape(const std::string& Text)
+{
+    std::string out;
+    for (unsigned char c : Text)
+    {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~')
+        {
+            out += static_cast<char>(c);
+            continue;
+        }
+        char hex[4];
+        std::snprintf(hex, sizeof(hex), "%%%02X", c);
+        out += hex;
+    }
+    return out;
+}
+
+/*
+* @brief checks whether the user owns an item with the single-item is-owned endpoint
+* @param Type kind of item ItemId refers to
+* @return true when the user owns it, throws std::runtime_error when the check fails
+*/
+bool RoPP::Inventory::Owns(long ItemId, ItemType Type)
+{
+    std::string key = "ropp:owns:" + std::to_string(this->UserId) + ":" + _m_itemType(Type) + ":" + std::to_string(ItemId);
+    std::string cached;
+    if (this->CacheLayer && this->CacheLayer->Get(key, cached))
+        return cached == "1";
+
+    json owned;
+    try
+    {
+        owned = FetchJson("https://inventory.roblox.com/v1/users/" + std::to_string(this->UserId) + "/items/" + _m_itemType(Type) + "/" + std::to_string(ItemId) + "/is-owned", nullptr, Endpoint::Ownership);
+    }
+    catch (const json::exception&)
+    {
+    }
+    if (!owned.is_boolean())
+        throw std::runtime_error("ownership check failed for user " + std::to_string(this->UserId));
+
+    bool owns = owned.get<bool>();
+    if (this->CacheLayer)
+        this->CacheLayer->Put(key, owns ? "1" : "0", owns ? this->OwnedTtl : this->NotOwnedTtl);
+    return owns;
+}
+
+/*
+* @brief starts a streaming scan of the user's inventory
+* @param AssetTypes asset type names to list, e.g. "Hat", the endpoint requires at least one
+*/
+RoPP::InventoryScan RoPP::Inventory::Scan(std::vector<std::string> AssetTypes, size_t PageSize)
+{
+    return InventoryScan(this->UserId, std::move(AssetTypes), PageSize);
+}
+
+/*
+* @brief routes ownership checks through a cache layer, nullptr disables caching
+* @param OwnedTtl how long an owned item is remembered
+* @param NotOwnedTtl how long an item the user lacks is remembered
+*/
+void RoPP::Inventory::SetCache(Cache* CacheLayer, std::chrono::seconds OwnedTtl, std::chrono::seconds NotOwnedTtl)
+{
+    this->CacheLayer = CacheLayer;
+    this->OwnedTtl = OwnedTtl;
+    this->NotOwnedTtl = NotOwnedTtl;
+}
+
+/*
+* @brief prepares a scan, the first page is requested by begin()
+* @param PageSize items per page, rounded up to 10, 25, 50 or 100 as the endpoint requires
+*/
+RoPP::InventoryScan::InventoryScan(long UserId, std::vector<std::string> AssetTypes, size_t PageSize) : UserId(UserId), PageSize(_m_pageSize(PageSize))
+{
+    for (size_t i = 0; i < AssetTypes.size(); i++)
+        this->Types += (i ? "," : "") + AssetTypes[i];
+}
+
+/*
+* @brief requests one page
+* @param Cursor cursor of the page, empty for the first
+*/
+RoPP::InventoryScan::Page RoPP::InventoryScan::Load(const std::string& Cursor) const
+{
+    std::string url = "https://inventory.roblox.com/v2/users/" + std::to_string(this->UserId) + "/inventory?assetTypes=" + this->Types
+        + "&limit=" + std::to_string(this->PageSize) + "&sortOrder=Asc";
+    if (!Cursor.empty())
+        url += "&cursor=" + _m_escape(Cursor);
+
+    Page page;
+    json body;
+    try
+    {
+        body = FetchJson(url, nullptr, Endpoint::Inventory);
+    }
+    catch (const json::exception&)
+    {
+        return page;
+    }
+    if (!body.is_object() || !body.contains("data") || !body["data"].is_array())
+        return page;
+
+    page.Items.reserve(body["data"].size());
+    for (const json& item : body["data"])
+    {
+        InventoryItem entry;
+        entry.AssetId = item.value("assetId", 0L);
+        entry.UserAssetId = item.value("userAssetId", 0L);
+        entry.Name = item.value("name", item.value("assetName", ""));
+        entry.AssetType = item.value("assetType", "");
+        entry.Created = item.value("created", "");
+        page.Items.push_back(std::move(entry));
+    }
+    if (body.contains("nextPageCursor") && body["nextPageCursor"].is_string())
+        page.Next = body["nextPageCursor"].get<std::string>();
+    page.Ok = true;
+    return page;
+}
+
+void RoPP::InventoryScan::Request(const std::string& Cursor)
+{
+    this->Prefetch = std::async(std::launch::async, [this, Cursor] { return this->Load(Cursor); });
+    this->More = true;
+}
+
+/*
+* @brief moves past exhausted pages, swapping in the prefetched one and prefetching the one after
+* @return false once the inventory ended or a page failed
+*/
+bool RoPP::InventoryScan::Advance()
+{
+    while (this->Index >= this->Items.size())
+    {
+        if (!this->More)
+        {
+            this->Done = true;
+            return false;
+        }
+
+        Page page = this->Prefetch.get();
+        this->More = false;
+        this->Loaded++;
+        if (!page.Ok)
+        {
+            this->Failed = true;
+            return false;
+        }
+
+        this->Items = std::move(page.Items);
+        this->Index = 0;
+        if (!page.Next.empty())
+            this->Request(page.Next);
+    }
+    return true;
+}
+
+RoPP::InventoryScan::Iterator RoPP::InventoryScan::begin()
+{
+    if (!this->Started)
+    {
+        this->Started = true;
+        this->Request("");
+    }
+    return this->Advance() ? Iterator(this) : Iterator();
+}
+
+RoPP::InventoryScan::Iterator& RoPP::InventoryScan::Iterator::operator++()
+{
+    this->Scan->Index++;
+    if (!this->Scan->Advance())
+        this->Scan = nullptr;
+    return *this;
+}
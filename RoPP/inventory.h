@@ -0,0 +1,107 @@
+#pragma once
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+
+namespace RoPP
+{
+    enum class ItemType { Asset, GamePass, Badge, Bundle };
+
+    struct InventoryItem
+    {
+        long AssetId = 0;
+        long UserAssetId = 0;
+        std::string Name;
+        std::string AssetType;
+        std::string Created;
+    };
+
+    /*
+    * Streams a user's whole inventory from inventory.roblox.com/v2 one cursor page at a time.
+    * The next page is requested in the background as soon as the current one arrives, so
+    * walking a page overlaps the round trip for the next:
+    *   for (const RoPP::InventoryItem& item : RoPP::InventoryScan(user, { "Hat", "Face" }))
+    *       ...
+    * A failed page ends the iteration early; Complete tells the two apart.
+    */
+    class InventoryScan
+    {
+        public:
+            class Iterator
+            {
+                public:
+                    using iterator_category = std::input_iterator_tag;
+                    using value_type = InventoryItem;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = const InventoryItem*;
+                    using reference = const InventoryItem&;
+
+                    explicit Iterator(InventoryScan* Scan = nullptr) : Scan(Scan) {}
+
+                    reference operator*() const { return this->Scan->Items[this->Scan->Index]; }
+                    pointer operator->() const { return &**this; }
+                    Iterator& operator++();
+                    bool operator==(const Iterator& Other) const { return this->Scan == Other.Scan; }
+                    bool operator!=(const Iterator& Other) const { return this->Scan != Other.Scan; }
+
+                private:
+                    InventoryScan* Scan;
+            };
+
+            InventoryScan(long UserId, std::vector<std::string> AssetTypes, size_t PageSize = 100);
+            InventoryScan(const InventoryScan&) = delete; // the prefetch and live iterators point at this scan
+            InventoryScan& operator=(const InventoryScan&) = delete;
+
+            Iterator begin();
+            Iterator end() { return Iterator(); }
+            bool Complete() const { return this->Done && !this->Failed; }
+            size_t Pages() const { return this->Loaded; }
+
+        private:
+            struct Page
+            {
+                std::vector<InventoryItem> Items;
+                std::string Next;
+                bool Ok = false;
+            };
+
+            Page Load(const std::string& Cursor) const;
+            void Request(const std::string& Cursor);
+            bool Advance();
+
+            long UserId;
+            std::string Types;
+            size_t PageSize;
+            std::vector<InventoryItem> Items;
+            size_t Index = 0;
+            size_t Loaded = 0;
+            bool Started = false;
+            bool Done = false;
+            bool Failed = false;
+            bool More = false;
+            std::future<Page> Prefetch;
+    };
+
+    class Inventory
+    {
+        public:
+            bool Owns(long ItemId, ItemType Type = ItemType::Asset);
+            InventoryScan Scan(std::vector<std::string> AssetTypes, size_t PageSize = 100);
+            void SetCache(Cache* CacheLayer, std::chrono::seconds OwnedTtl = std::chrono::hours(1), std::chrono::seconds NotOwnedTtl = std::chrono::minutes(5));
+
+            Inventory(long UserId)
+            {
+                this->UserId = UserId;
+            }
+
+        private:
+            long UserId;
+            Cache* CacheLayer = nullptr;
+            std::chrono::seconds OwnedTtl{ 3600 };
+            std::chrono::seconds NotOwnedTtl{ 300 };
+    };
+}
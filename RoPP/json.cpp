@@ -0,0 +1,10 @@
+#include "json.h"
+
+/*
+* @brief parses a response body, the only instantiation of the json parser in RoPP
+* @return parsed json, throws json::parse_error on malformed input
+*/
+json RoPP::ParseJson(const std::string& Body)
+{
+    return json::parse(Body);
+}
@@ -0,0 +1,16 @@
+#pragma once
+/*
+* The full json type, for translation units that build or read json values. Public RoPP
+* headers only need RoPP/json_fwd.h. Parse through RoPP::ParseJson so the parser, the bulk
+* of basic_json, is instantiated in json.cpp alone; the rest is small and inlined where used.
+*/
+#include <string>
+
+#include "../include/json.hpp"
+#include "flat_map.h"
+#include "json_fwd.h"
+
+namespace RoPP
+{
+    json ParseJson(const std::string& Body);
+}
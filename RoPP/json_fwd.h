@@ -0,0 +1,14 @@
+#pragma once
+/*
+* The json type RoPP's public headers name, without the cost of the full nlohmann header:
+* nlohmann::basic_json with object storage in RoPP::FlatMap (see flat_map.h).
+*/
+#include "../include/json_fwd.hpp"
+
+namespace RoPP
+{
+    template <class Key, class T, class IgnoredLess, class Allocator>
+    struct FlatMap;
+}
+
+using json = nlohmann::basic_json<RoPP::FlatMap>;
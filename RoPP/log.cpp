@@ -0,0 +1,233 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "log.h"
+#include "ring.h"
+
+// internal linkage, trace.cpp has its own _m_Buffer and _m_Local
+namespace
+{
+struct _m_Buffer
+{
+    RoPP::SpscRing<RoPP::LogRecord, 8192> Ring;
+    std::atomic<bool> Retired{ false };
+    uint32_t Thread = 0;
+};
+
+struct _m_Local
+{
+    std::shared_ptr<_m_Buffer> Buffer;
+
+    ~_m_Local()
+    {
+        if (Buffer)
+            Buffer->Retired = true;
+    }
+};
+}
+
+enum : int { _m_idle, _m_running, _m_stopped };
+
+static struct
+{
+    std::mutex Mutex;
+    std::condition_variable Wake;
+    std::thread Thread;
+    bool Stopping = false;
+    std::FILE* File = nullptr;
+    RoPP::LogFormat Format = RoPP::LogFormat::Text;
+    std::atomic<int> State{ _m_idle };
+    std::atomic<uint64_t> Dropped{ 0 };
+
+    std::mutex RegistryMutex;
+    std::vector<std::shared_ptr<_m_Buffer>> Buffers;
+    uint32_t NextThread = 1;
+} _m_logger;
+
+static thread_local _m_Local _m_local;
+
+static const char* _m_levelName(RoPP::LogLevel level)
+{
+    switch (level)
+    {
+    case RoPP::LogLevel::Trace: return "TRACE";
+    case RoPP::LogLevel::Debug: return "DEBUG";
+    case RoPP::LogLevel::Info: return "INFO";
+    case RoPP::LogLevel::Warn: return "WARN";
+    default: return "ERROR";
+    }
+}
+
+static const char* _m_eventName(RoPP::LogEvent event)
+{
+    switch (event)
+    {
+    case RoPP::LogEvent::RequestStart: return "request_start";
+    case RoPP::LogEvent::RequestDone: return "request_done";
+    case RoPP::LogEvent::RequestFailed: return "request_failed";
+    case RoPP::LogEvent::CacheHit: return "cache_hit";
+    case RoPP::LogEvent::QueueDrop: return "queue_drop";
+    case RoPP::LogEvent::BrownoutStart: return "brownout_start";
+    case RoPP::LogEvent::BrownoutEnd: return "brownout_end";
+    case RoPP::LogEvent::StaleServed: return "stale_served";
+    case RoPP::LogEvent::PollFailed: return "poll_failed";
+    default: return "cache_miss";
+    }
+}
+
+static void _m_write(const std::vector<RoPP::LogRecord>& records)
+{
+    std::FILE* file = _m_logger.File;
+    if (records.empty() || !file)
+        return;
+
+    if (_m_logger.Format == RoPP::LogFormat::Binary)
+        std::fwrite(records.data(), sizeof(RoPP::LogRecord), records.size(), file);
+    else
+    {
+        for (auto& record : records)
+        {
+            std::time_t seconds = record.Time / 1000000000;
+            std::tm utc;
+            gmtime_r(&seconds, &utc);
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+
+            std::fprintf(file, "%s.%06lluZ %-5s %s endpoint=%s code=%d bytes=%llu latency_us=%llu thread=%u\n",
+                stamp, (unsigned long long)(record.Time % 1000000000 / 1000), _m_levelName(record.Level), _m_eventName(record.Event),
+                RoPP::EndpointName(record.Id), record.Code, (unsigned long long)record.Bytes, (unsigned long long)(record.Latency / 1000), record.Thread);
+        }
+    }
+    std::fflush(file);
+}
+
+static void _m_drain()
+{
+    std::vector<std::shared_ptr<_m_Buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_m_logger.RegistryMutex);
+        buffers = _m_logger.Buffers;
+    }
+
+    std::vector<RoPP::LogRecord> records;
+    RoPP::LogRecord record;
+    for (auto& buffer : buffers)
+        while (buffer->Ring.TryPop(record))
+            records.push_back(record);
+    _m_write(records);
+
+    std::lock_guard<std::mutex> lock(_m_logger.RegistryMutex);
+    auto& all = _m_logger.Buffers;
+    for (size_t i = 0; i < all.size();)
+    {
+        if (all[i]->Retired && all[i]->Ring.Empty())
+        {
+            all[i] = all.back();
+            all.pop_back();
+        }
+        else
+            i++;
+    }
+}
+
+/*
+* @brief starts the background flusher, Write starts one on stderr when none was started;
+* it is stopped at exit when Stop was not called
+* @param Path log file, stderr when empty
+* @param Format text lines or raw LogRecord structs
+*/
+void RoPP::Logger::Start(const std::string& Path, LogFormat Format)
+{
+    Stop();
+
+    std::lock_guard<std::mutex> lock(_m_logger.Mutex);
+    _m_logger.File = Path.empty() ? stderr : std::fopen(Path.c_str(), Format == LogFormat::Binary ? "wb" : "w");
+    if (!_m_logger.File)
+        throw std::runtime_error("cannot open log file " + Path);
+
+    _m_logger.Format = Format;
+    _m_logger.Stopping = false;
+    _m_logger.Thread = std::thread([]
+    {
+        std::unique_lock<std::mutex> lock(_m_logger.Mutex);
+        while (!_m_logger.Stopping)
+        {
+            _m_logger.Wake.wait_for(lock, std::chrono::milliseconds(100));
+            _m_drain();
+        }
+    });
+    _m_logger.State = _m_running;
+    // joins the thread before the static holding it is destroyed, or exit would terminate with it still joinable
+    static std::once_flag registered;
+    std::call_once(registered, [] { std::atexit(Stop); });
+}
+
+/*
+* @brief flushes every buffered record and stops the flusher, later records are dropped
+*/
+void RoPP::Logger::Stop()
+{
+    _m_logger.State = _m_stopped;
+    {
+        std::lock_guard<std::mutex> lock(_m_logger.Mutex);
+        _m_logger.Stopping = true;
+    }
+    _m_logger.Wake.notify_all();
+    if (_m_logger.Thread.joinable())
+        _m_logger.Thread.join();
+
+    std::lock_guard<std::mutex> lock(_m_logger.Mutex);
+    if (!_m_logger.File)
+        return;
+
+    _m_drain();
+    if (_m_logger.File != stderr)
+        std::fclose(_m_logger.File);
+    _m_logger.File = nullptr;
+}
+
+/*
+* @brief gets the number of records lost because a thread's ring was full
+* @return dropped record count
+*/
+uint64_t RoPP::Logger::Dropped()
+{
+    return _m_logger.Dropped;
+}
+
+/*
+* @brief appends a record to the calling thread's ring, use ROPP_LOG to skip disabled levels
+*/
+void RoPP::Logger::Write(LogLevel Level, LogEvent Event, Endpoint Id, int32_t Code, uint64_t Bytes, uint64_t Latency)
+{
+    int state = _m_logger.State.load(std::memory_order_acquire);
+    if (state == _m_idle)
+    {
+        static std::once_flag started;
+        std::call_once(started, [] { if (_m_logger.State == _m_idle) Start(); });
+    }
+    else if (state == _m_stopped)
+        return;
+
+    if (!_m_local.Buffer)
+    {
+        auto buffer = std::make_shared<_m_Buffer>();
+        std::lock_guard<std::mutex> lock(_m_logger.RegistryMutex);
+        buffer->Thread = _m_logger.NextThread++;
+        _m_logger.Buffers.push_back(buffer);
+        _m_local.Buffer = buffer;
+    }
+
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    LogRecord record{ now, Latency, Bytes, Code, _m_local.Buffer->Thread, Level, Event, Id };
+    if (!_m_local.Buffer->Ring.TryPush(record))
+        _m_logger.Dropped++;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "endpoint.h"
+
+namespace RoPP
+{
+    enum class LogLevel : uint8_t { Trace, Debug, Info, Warn, Error, Off };
+    enum class LogEvent : uint8_t { RequestStart, RequestDone, RequestFailed, CacheHit, CacheMiss, QueueDrop, BrownoutStart, BrownoutEnd, StaleServed, PollFailed };
+    enum class LogFormat { Text, Binary };
+
+    // fixed size record, written as is by LogFormat::Binary
+    struct LogRecord
+    {
+        uint64_t Time;
+        uint64_t Latency;
+        uint64_t Bytes;
+        int32_t Code;
+        uint32_t Thread;
+        LogLevel Level;
+        LogEvent Event;
+        Endpoint Id;
+    };
+
+    class Logger
+    {
+        public:
+            static void Start(const std::string& Path = "", LogFormat Format = LogFormat::Text);
+            static void Stop();
+            static uint64_t Dropped();
+
+            static void SetLevel(LogLevel Level) { Threshold.store(Level, std::memory_order_relaxed); }
+            static LogLevel Level() { return Threshold.load(std::memory_order_relaxed); }
+            static bool Enabled(LogLevel Level) { return Level >= Threshold.load(std::memory_order_relaxed); }
+            static void Write(LogLevel Level, LogEvent Event, Endpoint Id, int32_t Code, uint64_t Bytes, uint64_t Latency);
+
+        private:
+#ifdef _VERBOSE
+            static inline std::atomic<LogLevel> Threshold{ LogLevel::Debug };
+#else
+            static inline std::atomic<LogLevel> Threshold{ LogLevel::Off };
+#endif
+    };
+}
+
+// records an event when the level is enabled; disabled levels cost one relaxed load
+#define ROPP_LOG(level, ...) do { if (RoPP::Logger::Enabled(level)) RoPP::Logger::Write(level, __VA_ARGS__); } while (0)
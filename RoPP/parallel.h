@@ -0,0 +1,37 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace RoPP
+{
+    // threads ParallelFor runs Jobs on, the caller included
+    inline size_t ParallelWorkers(size_t Jobs, size_t Concurrency)
+    {
+        return std::min(std::max<size_t>(Concurrency, 1), std::max<size_t>(Jobs, 1));
+    }
+
+    /*
+    * Calls Work(Job, Worker) for every job in [0, Jobs), spread over ParallelWorkers threads
+    * that take the next job from a shared index. The calling thread is worker 0 and the
+    * call returns once every job is done. Work must not throw.
+    */
+    template <typename Fn>
+    void ParallelFor(size_t Jobs, size_t Concurrency, Fn&& Work)
+    {
+        std::atomic<size_t> next{ 0 };
+        auto run = [&](size_t Worker)
+        {
+            for (size_t job; (job = next++) < Jobs;)
+                Work(job, Worker);
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < ParallelWorkers(Jobs, Concurrency); i++)
+            threads.emplace_back(run, i);
+        run(0);
+        for (auto& thread : threads)
+            thread.join();
+    }
+}
@@ -0,0 +1,18 @@
+#include "probes.h"
+
+#ifdef ROPP_HAS_USDT
+// semaphores live in .probes so tracers can find and raise them when attaching
+#define ROPP_DEFINE_SEMAPHORE(name) ROPP_PROBE_SEMAPHORE(name) __attribute__((unused, section(".probes"))) = 0
+
+extern "C"
+{
+    ROPP_DEFINE_SEMAPHORE(request_start);
+    ROPP_DEFINE_SEMAPHORE(connect_done);
+    ROPP_DEFINE_SEMAPHORE(first_byte);
+    ROPP_DEFINE_SEMAPHORE(request_done);
+    ROPP_DEFINE_SEMAPHORE(parse_start);
+    ROPP_DEFINE_SEMAPHORE(parse_done);
+    ROPP_DEFINE_SEMAPHORE(cache_hit);
+    ROPP_DEFINE_SEMAPHORE(cache_miss);
+}
+#endif
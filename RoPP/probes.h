@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+* USDT static tracepoints, provider "ropp". Built in when compiled with ROPP_USDT and
+* <sys/sdt.h> (systemtap-sdt-dev) is available, otherwise every probe compiles away.
+*
+*   request_start  (endpoint, request bytes, 0)
+*   connect_done   (endpoint, 0, connect ns)
+*   first_byte     (endpoint, 0, time to first byte ns)
+*   request_done   (endpoint, body bytes, total ns)
+*   parse_start    (endpoint, body bytes, 0)
+*   parse_done     (endpoint, body bytes, parse ns)
+*   cache_hit      (endpoint, value bytes, lookup ns)
+*   cache_miss     (endpoint, 0, lookup ns)
+*
+* Each probe has a semaphore that perf/bpftrace raise while attached; arguments are only
+* computed behind ROPP_PROBE_ENABLED, so an unattached probe costs a load and a nop.
+*   bpftrace -e 'usdt:./libropp.so:ropp:request_done { @[arg0] = hist(arg2 / 1000); }'
+*/
+
+#if defined(ROPP_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define ROPP_HAS_USDT 1
+#endif
+#endif
+
+#ifdef ROPP_HAS_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define ROPP_PROBE_SEMAPHORE(name) unsigned short ropp_##name##_semaphore
+extern "C"
+{
+    extern ROPP_PROBE_SEMAPHORE(request_start);
+    extern ROPP_PROBE_SEMAPHORE(connect_done);
+    extern ROPP_PROBE_SEMAPHORE(first_byte);
+    extern ROPP_PROBE_SEMAPHORE(request_done);
+    extern ROPP_PROBE_SEMAPHORE(parse_start);
+    extern ROPP_PROBE_SEMAPHORE(parse_done);
+    extern ROPP_PROBE_SEMAPHORE(cache_hit);
+    extern ROPP_PROBE_SEMAPHORE(cache_miss);
+}
+
+#define ROPP_PROBE_ENABLED(name) __builtin_expect(ropp_##name##_semaphore != 0, 0)
+#define ROPP_PROBE(name, endpoint, bytes, latency) \
+    STAP_PROBE3(ropp, name, static_cast<int>(endpoint), static_cast<unsigned long long>(bytes), static_cast<unsigned long long>(latency))
+#else
+#define ROPP_PROBE_ENABLED(name) false
+#define ROPP_PROBE(name, endpoint, bytes, latency) do { (void)sizeof((endpoint), (bytes), (latency)); } while (0)
+#endif
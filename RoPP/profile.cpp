@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#include "alloc.h"
+#include "profile.h"
+
+static thread_local RoPP::CallProfile* _m_active = nullptr;
+
+static uint64_t _m_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+* @brief splits a finished transfer into its network phases using curl's timings
+*/
+void RoPP::CallProfile::AddTransfer(const timings_t& Timings, size_t Bytes)
+{
+    auto span = [](curl_off_t from, curl_off_t to) { return to > from ? static_cast<uint64_t>(to - from) * 1000 : 0; };
+
+    this->Dns += span(0, Timings.nameLookup);
+    this->Connect += span(Timings.nameLookup, Timings.connect);
+    if (Timings.appConnect)
+        this->Tls += span(Timings.connect, Timings.appConnect);
+    this->Ttfb += span(Timings.preTransfer, Timings.startTransfer);
+    this->Receive += span(Timings.startTransfer, Timings.total);
+    this->Bytes += Bytes;
+    this->Requests++;
+}
+
+/*
+* @brief profiles every RoPP call made by this thread until the scope ends
+*/
+RoPP::ProfileScope::ProfileScope(CallProfile& Profile) : Profile(Profile), Saved(_m_active), Begin(_m_now())
+{
+    AllocCounters allocated = ThreadAllocations();
+    this->Allocations = allocated.Allocations;
+    this->AllocatedBytes = allocated.Bytes;
+    _m_active = &Profile;
+}
+
+RoPP::ProfileScope::~ProfileScope()
+{
+    AllocCounters allocated = ThreadAllocations();
+    this->Profile.Allocations += allocated.Allocations - this->Allocations;
+    this->Profile.AllocatedBytes += allocated.Bytes - this->AllocatedBytes;
+    this->Profile.Total += _m_now() - this->Begin;
+    _m_active = this->Saved;
+}
+
+/*
+* @brief gets the profile calls on this thread should record into
+* @return active profile, nullptr when profiling is off
+*/
+RoPP::CallProfile* RoPP::ProfileScope::Active()
+{
+    return _m_active;
+}
+
+/*
+* @brief accumulates a profile into the totals of its endpoint
+*/
+void RoPP::ProfileSummary::Add(const CallProfile& Profile)
+{
+    size_t index = static_cast<size_t>(Profile.Id);
+    if (index >= this->Totals.size())
+        index = 0;
+
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    CallProfile& total = this->Totals[index];
+    total.Total += Profile.Total;
+    total.Queued += Profile.Queued;
+    total.Cache += Profile.Cache;
+    total.Dns += Profile.Dns;
+    total.Connect += Profile.Connect;
+    total.Tls += Profile.Tls;
+    total.Ttfb += Profile.Ttfb;
+    total.Receive += Profile.Receive;
+    total.Decode += Profile.Decode;
+    total.Bytes += Profile.Bytes;
+    total.Allocations += Profile.Allocations;
+    total.AllocatedBytes += Profile.AllocatedBytes;
+    total.Requests += Profile.Requests;
+    total.CacheHits += Profile.CacheHits;
+    this->Calls[index]++;
+    if (Profile.Total > this->Slowest[index])
+        this->Slowest[index] = Profile.Total;
+}
+
+/*
+* @brief renders the totals as folded stacks (frame;frame weight), weights in microseconds
+* @return one line per endpoint and phase, ready for flamegraph.pl
+*/
+std::string RoPP::ProfileSummary::Folded()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::ostringstream out;
+    for (size_t i = 0; i < this->Totals.size(); i++)
+    {
+        if (!this->Calls[i])
+            continue;
+
+        const CallProfile& total = this->Totals[i];
+        std::string root = std::string("ropp;") + EndpointName(static_cast<Endpoint>(i));
+        uint64_t accounted = 0;
+        auto line = [&](const char* frames, uint64_t ns)
+        {
+            accounted += ns;
+            if (ns / 1000)
+                out << root << ";" << frames << " " << ns / 1000 << "\n";
+        };
+        line("queue", total.Queued);
+        line("cache", total.Cache);
+        line("network;dns", total.Dns);
+        line("network;connect", total.Connect);
+        line("network;tls", total.Tls);
+        line("network;ttfb", total.Ttfb);
+        line("network;receive", total.Receive);
+        line("decode", total.Decode);
+
+        if (total.Total > accounted && (total.Total - accounted) / 1000)
+            out << root << " " << (total.Total - accounted) / 1000 << "\n";
+    }
+    return out.str();
+}
+
+/*
+* @brief renders a per endpoint table of call counts and mean phase times
+* @return human readable report, times in microseconds
+*/
+std::string RoPP::ProfileSummary::Report()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::ostringstream out;
+    out << "endpoint         calls   mean_us    max_us  queue   cache   network  decode  bytes/call  allocs/call  hit%\n";
+    for (size_t i = 0; i < this->Totals.size(); i++)
+    {
+        uint64_t calls = this->Calls[i];
+        if (!calls)
+            continue;
+
+        const CallProfile& total = this->Totals[i];
+        uint64_t network = total.Dns + total.Connect + total.Tls + total.Ttfb + total.Receive;
+        char row[256];
+        std::snprintf(row, sizeof(row), "%-16s %6llu %9.1f %9.1f %6.1f %7.1f %9.1f %7.1f %11llu %12llu %5.1f\n",
+            EndpointName(static_cast<Endpoint>(i)), (unsigned long long)calls,
+            total.Total / 1000.0 / calls, this->Slowest[i] / 1000.0, total.Queued / 1000.0 / calls, total.Cache / 1000.0 / calls,
+            network / 1000.0 / calls, total.Decode / 1000.0 / calls, (unsigned long long)(total.Bytes / calls),
+            (unsigned long long)(total.Allocations / calls), 100.0 * total.CacheHits / calls);
+        out << row;
+    }
+    return out.str();
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "../include/request.hpp"
+#include "endpoint.h"
+
+namespace RoPP
+{
+    // where one call spent its time, all durations in nanoseconds
+    struct CallProfile
+    {
+        Endpoint Id = Endpoint::Unknown;
+        uint64_t Total = 0;
+        uint64_t Queued = 0;
+        uint64_t Cache = 0;
+        uint64_t Dns = 0;
+        uint64_t Connect = 0;
+        uint64_t Tls = 0;
+        uint64_t Ttfb = 0;
+        uint64_t Receive = 0;
+        uint64_t Decode = 0;
+        uint64_t Bytes = 0;
+        uint64_t Allocations = 0;
+        uint64_t AllocatedBytes = 0;
+        uint32_t Requests = 0;
+        uint32_t CacheHits = 0;
+
+        void AddTransfer(const timings_t& Timings, size_t Bytes);
+    };
+
+    class ProfileScope
+    {
+        public:
+            explicit ProfileScope(CallProfile& Profile);
+            ~ProfileScope();
+
+            static CallProfile* Active();
+
+        private:
+            CallProfile& Profile;
+            CallProfile* Saved;
+            uint64_t Begin;
+            uint64_t Allocations;
+            uint64_t AllocatedBytes;
+    };
+
+    /*
+    * Runs Call with profiling enabled on this thread and returns its result with the profile:
+    *   auto [groups, profile] = RoPP::Explain([&] { return user.GetGroups(); });
+    */
+    template <typename Fn>
+    auto Explain(Fn&& Call) -> std::pair<decltype(Call()), CallProfile>
+    {
+        CallProfile profile;
+        std::pair<decltype(Call()), CallProfile> result;
+        {
+            ProfileScope scope(profile);
+            result.first = Call();
+        }
+        result.second = profile;
+        return result;
+    }
+
+    // per endpoint totals of many profiles, exportable as folded stacks for flamegraph.pl
+    class ProfileSummary
+    {
+        public:
+            void Add(const CallProfile& Profile);
+            std::string Folded();
+            std::string Report();
+
+        private:
+            std::mutex Mutex;
+            std::array<CallProfile, static_cast<size_t>(Endpoint::Count)> Totals{};
+            std::array<uint64_t, static_cast<size_t>(Endpoint::Count)> Calls{};
+            std::array<uint64_t, static_cast<size_t>(Endpoint::Count)> Slowest{};
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+namespace RoPP
+{
+    /*
+    * Bounded single producer / single consumer ring. The owning thread pushes, one
+    * background thread pops; neither side ever blocks or takes a lock.
+    */
+    template <typename T, size_t Capacity>
+    class SpscRing
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "ring capacity must be a power of two");
+
+        public:
+            bool TryPush(const T& Item)
+            {
+                size_t head = this->Head.load(std::memory_order_relaxed);
+                if (head - this->Tail.load(std::memory_order_acquire) == Capacity)
+                    return false;
+
+                this->Slots[head & (Capacity - 1)] = Item;
+                this->Head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool TryPop(T& Item)
+            {
+                size_t tail = this->Tail.load(std::memory_order_relaxed);
+                if (tail == this->Head.load(std::memory_order_acquire))
+                    return false;
+
+                Item = this->Slots[tail & (Capacity - 1)];
+                this->Tail.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            // consumer side, a retired producer's ring is done once this holds
+            bool Empty() const
+            {
+                return this->Tail.load(std::memory_order_relaxed) == this->Head.load(std::memory_order_acquire);
+            }
+
+        private:
+            alignas(64) std::atomic<size_t> Head{ 0 };
+            alignas(64) std::atomic<size_t> Tail{ 0 };
+            alignas(64) T Slots[Capacity];
+    };
+}
@@ -1,12 +1,30 @@
 #include <string>
 
-#include "../include/json.hpp"
+#include "json_fwd.h"
+#include "badge.h"
+#include "brownout.h"
+#include "bus.h"
+#include "cache.h"
+#include "connection.h"
+#include "endpoint.h"
+#include "friends.h"
+#include "game.h"
+#include "graph.h"
+#include "inventory.h"
+#include "profile.h"
+#include "serialize.h"
+#include "shaper.h"
+#include "source.h"
+#include "trace.h"
+#include "transport.h"
 
-using json = nlohmann::json;
 using std::string;
 
 namespace RoPP
 {
+    std::string Fetch(const string& Url, Cache* CacheLayer = nullptr, Endpoint Id = Endpoint::Unknown);
+    json FetchJson(const string& Url, Cache* CacheLayer = nullptr, Endpoint Id = Endpoint::Unknown);
+
     class User
     {
         public:
@@ -15,6 +33,7 @@ namespace RoPP
             std::string GetDescription();
 
             json GetFriends(string Sort="Alphabetical");
+            FriendList GetFriendList();
             json GetFriendsOnline();
             int GetFriendsCount();
             json GetFollowers(string Sort="Asc", int Limit=10);
@@ -23,7 +42,8 @@ namespace RoPP
             int GetFollowingsCount();
             json GetGroups();
             int GetGroupsCount();
-            
+
+            void SetCache(Cache* CacheLayer);
 
 
             User(long UID)
@@ -33,5 +53,6 @@ namespace RoPP
 
         private:
             long UID;
+            Cache* CacheLayer = nullptr;
     };
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include <charconv>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ROPP_SSE2_ESCAPE
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "ropp.h"
+
+// what json::dump() writes for each byte below 0x20, quote and backslash, 0 for bytes written as they are
+static const char _m_escapes[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+
+template <size_t N>
+static void _m_raw(std::string& Out, const char (&Text)[N])
+{
+    Out.append(Text, N - 1);
+}
+
+static void _m_escape(std::string& Out, unsigned char Byte)
+{
+    char escape = _m_escapes[Byte];
+    if (escape != 'u')
+    {
+        const char pair[2] = { '\\', escape };
+        Out.append(pair, 2);
+        return;
+    }
+    static const char hex[] = "0123456789abcdef";
+    const char code[6] = { '\\', 'u', '0', '0', hex[Byte >> 4], hex[Byte & 15] };
+    Out.append(code, 6);
+}
+
+#ifdef ROPP_SSE2_ESCAPE
+static unsigned _m_lowestBit(unsigned Mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, Mask);
+    return index;
+#else
+    return __builtin_ctz(Mask);
+#endif
+}
+#endif
+
+/*
+* @brief appends Value as a quoted JSON string, checking 16 bytes at a time for ones that need escaping
+*/
+void RoPP::AppendJsonString(std::string& Out, const std::string& Value)
+{
+    const char* at = Value.data();
+    const char* end = at + Value.size();
+    const char* run = at; // start of the bytes not yet copied out
+    Out.reserve(Out.size() + Value.size() + 2);
+    Out.push_back('"');
+
+#ifdef ROPP_SSE2_ESCAPE
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (end - at >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(at));
+        // max(byte, 0x1F) == 0x1F picks out the bytes below 0x20 as unsigned
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask == 0)
+        {
+            at += 16;
+            continue;
+        }
+        at += _m_lowestBit(mask);
+        Out.append(run, at);
+        _m_escape(Out, static_cast<unsigned char>(*at));
+        run = ++at;
+    }
+#endif
+
+    for (; at < end; at++)
+    {
+        if (_m_escapes[static_cast<unsigned char>(*at)])
+        {
+            Out.append(run, at);
+            _m_escape(Out, static_cast<unsigned char>(*at));
+            run = at + 1;
+        }
+    }
+    Out.append(run, end);
+    Out.push_back('"');
+}
+
+void RoPP::AppendJsonInteger(std::string& Out, long long Value)
+{
+    char digits[24];
+    char* last = std::to_chars(digits, digits + sizeof(digits), Value).ptr;
+    Out.append(digits, last);
+}
+
+static void _m_bool(std::string& Out, bool Value)
+{
+    if (Value)
+        _m_raw(Out, "true");
+    else
+        _m_raw(Out, "false");
+}
+
+void RoPP::WriteJson(std::string& Out, const GameDetails& Value)
+{
+    _m_raw(Out, "{\"universeId\":");
+    AppendJsonInteger(Out, Value.UniverseId);
+    _m_raw(Out, ",\"rootPlaceId\":");
+    AppendJsonInteger(Out, Value.RootPlaceId);
+    _m_raw(Out, ",\"name\":");
+    AppendJsonString(Out, Value.Name);
+    _m_raw(Out, ",\"description\":");
+    AppendJsonString(Out, Value.Description);
+    _m_raw(Out, ",\"creatorId\":");
+    AppendJsonInteger(Out, Value.CreatorId);
+    _m_raw(Out, ",\"creatorName\":");
+    AppendJsonString(Out, Value.CreatorName);
+    _m_raw(Out, ",\"creatorType\":");
+    AppendJsonString(Out, Value.CreatorType);
+    _m_raw(Out, ",\"playing\":");
+    AppendJsonInteger(Out, Value.Playing);
+    _m_raw(Out, ",\"visits\":");
+    AppendJsonInteger(Out, Value.Visits);
+    _m_raw(Out, ",\"maxPlayers\":");
+    AppendJsonInteger(Out, Value.MaxPlayers);
+    _m_raw(Out, ",\"favorites\":");
+    AppendJsonInteger(Out, Value.Favorites);
+    _m_raw(Out, ",\"genre\":");
+    AppendJsonString(Out, Value.Genre);
+    _m_raw(Out, ",\"created\":");
+    AppendJsonString(Out, Value.Created);
+    _m_raw(Out, ",\"updated\":");
+    AppendJsonString(Out, Value.Updated);
+    Out.push_back('}');
+}
+
+void RoPP::WriteJson(std::string& Out, const PlaceDetails& Value)
+{
+    _m_raw(Out, "{\"placeId\":");
+    AppendJsonInteger(Out, Value.PlaceId);
+    _m_raw(Out, ",\"universeId\":");
+    AppendJsonInteger(Out, Value.UniverseId);
+    _m_raw(Out, ",\"name\":");
+    AppendJsonString(Out, Value.Name);
+    _m_raw(Out, ",\"description\":");
+    AppendJsonString(Out, Value.Description);
+    _m_raw(Out, ",\"builder\":");
+    AppendJsonString(Out, Value.Builder);
+    _m_raw(Out, ",\"builderId\":");
+    AppendJsonInteger(Out, Value.BuilderId);
+    _m_raw(Out, ",\"playable\":");
+    _m_bool(Out, Value.Playable);
+    Out.push_back('}');
+}
+
+void RoPP::WriteJson(std::string& Out, const PlayerCountDelta& Value)
+{
+    _m_raw(Out, "{\"universeId\":");
+    AppendJsonInteger(Out, Value.UniverseId);
+    _m_raw(Out, ",\"previous\":");
+    AppendJsonInteger(Out, Value.Previous);
+    _m_raw(Out, ",\"playing\":");
+    AppendJsonInteger(Out, Value.Playing);
+    Out.push_back('}');
+}
+
+void RoPP::WriteJson(std::string& Out, const BadgeAward& Value)
+{
+    _m_raw(Out, "{\"userId\":");
+    AppendJsonInteger(Out, Value.UserId);
+    _m_raw(Out, ",\"badgeId\":");
+    AppendJsonInteger(Out, Value.BadgeId);
+    _m_raw(Out, ",\"awarded\":");
+    _m_bool(Out, Value.Awarded);
+    _m_raw(Out, ",\"awardedDate\":");
+    AppendJsonString(Out, Value.AwardedDate);
+    Out.push_back('}');
+}
+
+void RoPP::WriteJson(std::string& Out, const InventoryItem& Value)
+{
+    _m_raw(Out, "{\"assetId\":");
+    AppendJsonInteger(Out, Value.AssetId);
+    _m_raw(Out, ",\"userAssetId\":");
+    AppendJsonInteger(Out, Value.UserAssetId);
+    _m_raw(Out, ",\"name\":");
+    AppendJsonString(Out, Value.Name);
+    _m_raw(Out, ",\"assetType\":");
+    AppendJsonString(Out, Value.AssetType);
+    _m_raw(Out, ",\"created\":");
+    AppendJsonString(Out, Value.Created);
+    Out.push_back('}');
+}
+
+void RoPP::WriteJson(std::string& Out, const Recommendation& Value)
+{
+    _m_raw(Out, "{\"userId\":");
+    AppendJsonInteger(Out, Value.UserId);
+    _m_raw(Out, ",\"mutual\":");
+    AppendJsonInteger(Out, Value.Mutual);
+    Out.push_back('}');
+}
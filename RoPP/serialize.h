@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "badge.h"
+#include "friends.h"
+#include "game.h"
+#include "inventory.h"
+
+namespace RoPP
+{
+    /*
+    * Writes typed results straight to JSON text, for servers that hand RoPP results on to
+    * their own clients. Output is appended to Out, so one buffer can be cleared and reused
+    * across responses without building a json value first:
+    *   buffer.clear();
+    *   RoPP::WriteJson(buffer, RoPP::Game::GetDetails(ids));
+    * Members come out in struct order, named in camelCase ("universeId", "rootPlaceId", ...).
+    * Strings are escaped the way json::dump() escapes them and must already be UTF-8, as
+    * everything parsed from a Roblox response is.
+    */
+    void WriteJson(std::string& Out, const GameDetails& Value);
+    void WriteJson(std::string& Out, const PlaceDetails& Value);
+    void WriteJson(std::string& Out, const PlayerCountDelta& Value);
+    void WriteJson(std::string& Out, const BadgeAward& Value);
+    void WriteJson(std::string& Out, const InventoryItem& Value);
+    void WriteJson(std::string& Out, const Recommendation& Value);
+
+    template <typename T>
+    void WriteJson(std::string& Out, const std::vector<T>& Values)
+    {
+        Out.push_back('[');
+        for (size_t i = 0; i < Values.size(); i++)
+        {
+            if (i)
+                Out.push_back(',');
+            WriteJson(Out, Values[i]);
+        }
+        Out.push_back(']');
+    }
+
+    // the building blocks, for writing results of your own
+    void AppendJsonString(std::string& Out, const std::string& Value);
+    void AppendJsonInteger(std::string& Out, long long Value);
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <thread>
+
+#include "shaper.h"
+
+static std::atomic<RoPP::BandwidthShaper*> _m_current{ nullptr };
+
+RoPP::TokenBucket::TokenBucket(uint64_t Rate, double Burst) : Limit(Rate)
+{
+    this->Capacity = std::max(static_cast<double>(Rate) * Burst, 16384.0);
+    this->Tokens = this->Capacity;
+    this->Refilled = std::chrono::steady_clock::now();
+}
+
+/*
+* @brief debits Bytes, which have already arrived
+* @return how long to wait before reading more, zero while the bucket is in credit or unlimited
+*/
+std::chrono::microseconds RoPP::TokenBucket::Take(uint64_t Bytes)
+{
+    if (this->Limit == 0)
+        return std::chrono::microseconds(0);
+
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - this->Refilled).count();
+    this->Refilled = now;
+    this->Tokens = std::min(this->Capacity, this->Tokens + elapsed * this->Limit);
+    this->Tokens -= static_cast<double>(Bytes);
+    if (this->Tokens >= 0)
+        return std::chrono::microseconds(0);
+    return std::chrono::microseconds(static_cast<int64_t>(-this->Tokens * 1e6 / this->Limit));
+}
+
+RoPP::BandwidthShaper::BandwidthShaper(BandwidthPolicy Policy)
+    : Policy(Policy), Global(Policy.GlobalRate, Policy.Burst), Bulk(Policy.BulkRate, Policy.Burst)
+{
+}
+
+/*
+* @brief accounts bytes a transfer received, holding a bulk transfer back while its budgets are in debt
+*/
+void RoPP::BandwidthShaper::Consume(TrafficClass Class, uint64_t Bytes)
+{
+    this->Bytes[static_cast<size_t>(Class)].fetch_add(Bytes, std::memory_order_relaxed);
+    std::chrono::microseconds wait = this->Global.Take(Bytes);
+    if (Class == TrafficClass::Interactive)
+        return;
+
+    wait = std::max(wait, this->Bulk.Take(Bytes));
+    if (wait.count() <= 0)
+        return;
+    this->Waits.fetch_add(1, std::memory_order_relaxed);
+    this->Waited.fetch_add(wait.count(), std::memory_order_relaxed);
+    std::this_thread::sleep_for(wait);
+}
+
+/*
+* @brief the most a single transfer of a class may receive per second
+* @return bytes per second, 0 for no cap
+*/
+uint64_t RoPP::BandwidthShaper::TransferCap(TrafficClass Class) const
+{
+    if (Class == TrafficClass::Interactive)
+        return 0;
+    uint64_t global = this->Policy.GlobalRate, bulk = this->Policy.BulkRate;
+    return global && bulk ? std::min(global, bulk) : std::max(global, bulk);
+}
+
+RoPP::BandwidthStats RoPP::BandwidthShaper::Stats() const
+{
+    BandwidthStats stats;
+    for (size_t i = 0; i < 2; i++)
+        stats.Bytes[i] = this->Bytes[i].load(std::memory_order_relaxed);
+    stats.Waits = this->Waits.load(std::memory_order_relaxed);
+    stats.Waited = this->Waited.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/*
+* @brief installs the shaper CurlTransport reports received bytes to, nullptr disables shaping
+*/
+void RoPP::SetBandwidthShaper(BandwidthShaper* Shaper)
+{
+    _m_current.store(Shaper, std::memory_order_release);
+}
+
+RoPP::BandwidthShaper* RoPP::CurrentBandwidthShaper()
+{
+    return _m_current.load(std::memory_order_acquire);
+}
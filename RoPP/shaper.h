@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "transport.h"
+
+namespace RoPP
+{
+    // ingress budgets in bytes per second, 0 leaves a budget unlimited
+    struct BandwidthPolicy
+    {
+        uint64_t GlobalRate = 0;  // every transfer together
+        uint64_t BulkRate = 0;    // TrafficClass::Bulk transfers together
+        double Burst = 0.25;      // seconds of each budget that may arrive back to back
+    };
+
+    struct BandwidthStats
+    {
+        uint64_t Bytes[2] = {};   // received, indexed by TrafficClass
+        uint64_t Waits = 0;       // times a bulk transfer was held back
+        uint64_t Waited = 0;      // microseconds bulk transfers spent held back
+    };
+
+    /*
+    * Token bucket whose balance may go negative: bytes that already arrived are always
+    * accounted, and the debt tells how long the next reader has to hold off.
+    */
+    class TokenBucket
+    {
+        public:
+            TokenBucket(uint64_t Rate, double Burst);
+
+            std::chrono::microseconds Take(uint64_t Bytes);
+            uint64_t Rate() const { return this->Limit; }
+
+        private:
+            std::mutex Mutex;
+            uint64_t Limit;
+            double Capacity;
+            double Tokens;
+            std::chrono::steady_clock::time_point Refilled;
+    };
+
+    /*
+    * Caps how fast CurlTransport drains response bodies. A bulk transfer over budget stops
+    * reading its socket until the buckets refill, so TCP flow control slows the sender
+    * rather than the host NIC filling up. Interactive transfers are never held back, but
+    * their bytes still count against the global budget, so bulk traffic yields to them.
+    * curl only reports progress every so often, so each bulk transfer is also capped at
+    * the smaller budget with CURLOPT_MAX_RECV_SPEED_LARGE to keep it from arriving in bursts.
+    * Holding back sleeps on the thread running the transfer, so under AsyncTransport a
+    * throttled bulk transfer keeps its worker busy; QueuePolicy::InteractiveWorkers keeps
+    * some workers for interactive jobs:
+    *   RoPP::BandwidthShaper shaper({ 50 << 20, 20 << 20 });
+    *   RoPP::SetBandwidthShaper(&shaper);
+    */
+    class BandwidthShaper
+    {
+        public:
+            explicit BandwidthShaper(BandwidthPolicy Policy);
+
+            void Consume(TrafficClass Class, uint64_t Bytes);
+            uint64_t TransferCap(TrafficClass Class) const;
+            BandwidthStats Stats() const;
+
+            const BandwidthPolicy Policy;
+
+        private:
+            TokenBucket Global;
+            TokenBucket Bulk;
+            std::atomic<uint64_t> Bytes[2] = {};
+            std::atomic<uint64_t> Waits{ 0 };
+            std::atomic<uint64_t> Waited{ 0 };
+    };
+
+    void SetBandwidthShaper(BandwidthShaper* Shaper);
+    BandwidthShaper* CurrentBandwidthShaper();
+}
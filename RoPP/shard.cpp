@@ -0,0 +1,342 @@
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shard.h"
+
+// result frame: u64 id | u8 ok | u32 length | data
+static constexpr size_t _m_resultHeader = 13;
+
+static uint64_t _m_mix(uint64_t x)
+{
+    // splitmix64 finaliser
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static bool _m_writeAll(int fd, const char* data, size_t size)
+{
+    while (size)
+    {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+[[noreturn]] static void _m_workerMain(int fd, const RoPP::ShardCoordinator::Job& work)
+{
+    std::string in;
+    char chunk[4096];
+    for (;;)
+    {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            _exit(0);
+        in.append(chunk, n);
+
+        size_t offset = 0;
+        std::string out;
+        for (; in.size() - offset >= sizeof(uint64_t); offset += sizeof(uint64_t))
+        {
+            uint64_t id;
+            std::memcpy(&id, in.data() + offset, sizeof(id));
+
+            uint8_t ok = 1;
+            std::string data;
+            try
+            {
+                data = work(static_cast<long>(id));
+            }
+            catch (const std::exception& e)
+            {
+                ok = 0;
+                data = e.what();
+            }
+
+            uint32_t size = static_cast<uint32_t>(data.size());
+            out.append(reinterpret_cast<const char*>(&id), sizeof(id));
+            out.push_back(static_cast<char>(ok));
+            out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            out += data;
+        }
+        in.erase(0, offset);
+
+        if (!_m_writeAll(fd, out.data(), out.size()))
+            _exit(1);
+    }
+}
+
+/*
+* @brief forks the worker processes, construct before starting any threads
+* @param Work job run inside a worker for every id routed to it
+* @param Window maximum ids outstanding per worker, bounds the work redone after a loss
+* @param MaxLosses lost workers an id may have been in flight on before it is failed instead of
+*        rerouted; ids that merely shared a window with the culprit are rerouted until then, and
+*        an id that crashes every worker it reaches takes down at most MaxLosses of them
+*/
+RoPP::ShardCoordinator::ShardCoordinator(size_t Workers, Job Work, size_t Window, size_t MaxLosses)
+    : Workers(Workers), Window(Window ? Window : 1), MaxLosses(MaxLosses ? MaxLosses : 1)
+{
+    for (size_t i = 0; i < Workers; i++)
+    {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0)
+            throw std::runtime_error("socketpair failed");
+
+        pid_t pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("fork failed");
+        if (pid == 0)
+        {
+            close(pair[0]);
+            for (size_t j = 0; j < i; j++)
+                close(this->Workers[j].Fd);
+            _m_workerMain(pair[1], Work);
+        }
+
+        close(pair[1]);
+        fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+        this->Workers[i].Pid = pid;
+        this->Workers[i].Fd = pair[0];
+        this->Workers[i].Alive = true;
+    }
+}
+
+RoPP::ShardCoordinator::~ShardCoordinator()
+{
+    for (auto& worker : this->Workers)
+    {
+        if (!worker.Alive)
+            continue;
+        close(worker.Fd);
+        waitpid(worker.Pid, nullptr, 0);
+    }
+}
+
+/*
+* @brief gets the live worker owning an id by rendezvous hashing, so losing a worker only moves its own ids
+* @return index of the owning worker
+*/
+size_t RoPP::ShardCoordinator::Owner(long Id) const
+{
+    size_t best = this->Workers.size();
+    uint64_t bestScore = 0;
+    for (size_t i = 0; i < this->Workers.size(); i++)
+    {
+        if (!this->Workers[i].Alive)
+            continue;
+
+        uint64_t score = _m_mix(static_cast<uint64_t>(Id) ^ _m_mix(i));
+        if (best == this->Workers.size() || score > bestScore)
+        {
+            best = i;
+            bestScore = score;
+        }
+    }
+
+    if (best == this->Workers.size())
+        throw std::runtime_error("no live shard workers");
+    return best;
+}
+
+/*
+* @brief gets the number of workers still running
+* @return live worker count
+*/
+size_t RoPP::ShardCoordinator::LiveWorkers() const
+{
+    size_t live = 0;
+    for (auto& worker : this->Workers)
+        live += worker.Alive;
+    return live;
+}
+
+void RoPP::ShardCoordinator::Run(const std::vector<long>& Ids, Sink OnResult)
+{
+    size_t next = 0;
+    this->Run([&](long& Id)
+    {
+        if (next == Ids.size())
+            return false;
+        Id = Ids[next++];
+        return true;
+    }, std::move(OnResult));
+}
+
+/*
+* @brief streams ids to their owning workers and merges the result streams as they arrive
+* @param Next produces the next id, returns false once the stream is exhausted
+* @param OnResult called in the coordinator for every result, in arrival order; ids given up
+*        after MaxLosses lost workers come back with Ok false and Data "shard worker lost"
+*/
+void RoPP::ShardCoordinator::Run(Source Next, Sink OnResult)
+{
+    const size_t maxBuffered = this->Window * this->Workers.size() * 4;
+    size_t buffered = 0;
+    bool exhausted = false;
+
+    std::vector<pollfd> fds;
+    std::vector<size_t> indices;
+    for (;;)
+    {
+        long id;
+        while (!exhausted && buffered < maxBuffered)
+        {
+            if (!Next(id))
+            {
+                exhausted = true;
+                break;
+            }
+            this->Workers[this->Owner(id)].Queue.push_back(id);
+            buffered++;
+        }
+
+        if (exhausted && buffered == 0)
+            return;
+
+        fds.clear();
+        indices.clear();
+        for (size_t i = 0; i < this->Workers.size(); i++)
+        {
+            Worker& worker = this->Workers[i];
+            if (!worker.Alive)
+                continue;
+
+            while (!worker.Queue.empty() && worker.InFlight < this->Window)
+            {
+                uint64_t queued = static_cast<uint64_t>(worker.Queue.front());
+                worker.Queue.pop_front();
+                worker.Out.append(reinterpret_cast<const char*>(&queued), sizeof(queued));
+                worker.Outstanding[static_cast<long>(queued)]++;
+                worker.InFlight++;
+            }
+
+            fds.push_back({ worker.Fd, static_cast<short>(POLLIN | (worker.Out.empty() ? 0 : POLLOUT)), 0 });
+            indices.push_back(i);
+        }
+
+        if (fds.empty())
+            throw std::runtime_error("no live shard workers");
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error("poll failed");
+        }
+
+        for (size_t f = 0; f < fds.size(); f++)
+        {
+            Worker& worker = this->Workers[indices[f]];
+            bool lost = fds[f].revents & (POLLERR | POLLNVAL);
+
+            if (fds[f].revents & POLLOUT)
+            {
+                ssize_t n = send(worker.Fd, worker.Out.data(), worker.Out.size(), MSG_NOSIGNAL);
+                if (n > 0)
+                    worker.Out.erase(0, n);
+                else if (n < 0 && errno != EAGAIN && errno != EINTR)
+                    lost = true;
+            }
+
+            if (fds[f].revents & (POLLIN | POLLHUP))
+            {
+                char chunk[65536];
+                ssize_t n;
+                while ((n = read(worker.Fd, chunk, sizeof(chunk))) > 0)
+                    worker.In.append(chunk, n);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+                    lost = true;
+
+                size_t offset = 0;
+                while (worker.In.size() - offset >= _m_resultHeader)
+                {
+                    uint64_t resultId;
+                    uint32_t size;
+                    std::memcpy(&resultId, worker.In.data() + offset, sizeof(resultId));
+                    std::memcpy(&size, worker.In.data() + offset + 9, sizeof(size));
+                    if (worker.In.size() - offset < _m_resultHeader + size)
+                        break;
+
+                    ShardResult result{ static_cast<long>(resultId), worker.In[offset + 8] != 0, worker.In.substr(offset + _m_resultHeader, size) };
+                    offset += _m_resultHeader + size;
+
+                    auto outstanding = worker.Outstanding.find(result.Id);
+                    if (outstanding == worker.Outstanding.end())
+                        continue;
+                    if (--outstanding->second == 0)
+                        worker.Outstanding.erase(outstanding);
+                    worker.InFlight--;
+                    buffered--;
+                    if (!this->Losses.empty())
+                        this->Losses.erase(result.Id);
+
+                    OnResult(result);
+                }
+                worker.In.erase(0, offset);
+            }
+
+            if (lost)
+            {
+                for (long failed : this->Lose(indices[f]))
+                {
+                    buffered--;
+                    OnResult({ failed, false, "shard worker lost" });
+                }
+            }
+        }
+    }
+}
+
+/*
+* @brief reaps a dead worker and reroutes its ids to their new owners: queued ones always, unanswered
+* ones until they have been in flight on MaxLosses lost workers
+* @return the unanswered ids given up on
+*/
+std::vector<long> RoPP::ShardCoordinator::Lose(size_t Index)
+{
+    Worker& worker = this->Workers[Index];
+    close(worker.Fd);
+    kill(worker.Pid, SIGKILL);
+    waitpid(worker.Pid, nullptr, 0);
+    worker.Alive = false;
+
+    // queued ids never reached the worker, any of the unanswered ones may have killed it
+    std::vector<long> orphans(worker.Queue.begin(), worker.Queue.end());
+    std::vector<long> failed;
+    for (auto& [id, count] : worker.Outstanding)
+    {
+        size_t& losses = this->Losses[id];
+        if (++losses >= this->MaxLosses)
+        {
+            failed.insert(failed.end(), count, id);
+            this->Losses.erase(id);
+        }
+        else
+            orphans.insert(orphans.end(), count, id);
+    }
+    worker.Queue.clear();
+    worker.Outstanding.clear();
+    worker.InFlight = 0;
+    worker.Out.clear();
+    worker.In.clear();
+
+    for (long id : orphans)
+        this->Workers[this->Owner(id)].Queue.push_back(id);
+    return failed;
+}
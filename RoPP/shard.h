@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace RoPP
+{
+    struct ShardResult
+    {
+        long Id;
+        bool Ok;
+        std::string Data;
+    };
+
+    class ShardCoordinator
+    {
+        public:
+            using Job = std::function<std::string(long)>;
+            using Source = std::function<bool(long&)>;
+            using Sink = std::function<void(const ShardResult&)>;
+
+            ShardCoordinator(size_t Workers, Job Work, size_t Window = 256, size_t MaxLosses = 2);
+            ~ShardCoordinator();
+
+            void Run(Source Next, Sink OnResult);
+            void Run(const std::vector<long>& Ids, Sink OnResult);
+            size_t LiveWorkers() const;
+            size_t Owner(long Id) const;
+
+        private:
+            struct Worker
+            {
+                pid_t Pid = -1;
+                int Fd = -1;
+                bool Alive = false;
+                std::deque<long> Queue;
+                std::unordered_map<long, size_t> Outstanding;
+                size_t InFlight = 0;
+                std::string Out;
+                std::string In;
+            };
+
+            std::vector<long> Lose(size_t Index);
+
+            std::vector<Worker> Workers;
+            size_t Window;
+            size_t MaxLosses;
+            std::unordered_map<long, size_t> Losses; // ids in flight on a lost worker, and how often
+    };
+}
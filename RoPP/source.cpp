@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "source.h"
+
+struct RoPP::SourceTransport::Source
+{
+    Source(const SourceAddress& Address, const ConnectionTuning& Tuning) : Address(Address), Share(Tuning.ReuseConnections, Tuning.ResumeSessions) {}
+
+    SourceAddress Address;
+    CurlShare Share; // connections, dns and tls sessions are pooled per source, never across them
+
+    uint64_t Requests = 0;
+    uint64_t Failures = 0;
+    uint64_t Throttled = 0;
+    uint32_t InFlight = 0;
+    uint32_t FailedRun = 0;
+    bool Ejected = false;
+    bool Probing = false;
+    std::chrono::steady_clock::time_point RestUntil{};
+};
+
+// failures that say something about the local address rather than the server's answer
+static bool _m_connectionFailure(CURLcode Code)
+{
+    switch (Code)
+    {
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_INTERFACE_FAILED:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_SSL_CONNECT_ERROR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+RoPP::SourceTransport::SourceTransport(const std::vector<SourceAddress>& Sources, SourcePolicy Policy, ConnectionTuning Tuning) : Policy(Policy), Tuning(Tuning)
+{
+    for (const SourceAddress& address : Sources)
+        this->Sources.push_back(std::make_unique<Source>(address, Tuning));
+}
+
+RoPP::SourceTransport::~SourceTransport() = default;
+
+/*
+* @brief performs the request from the least loaded healthy source address
+* @return the response of the request
+*/
+Response RoPP::SourceTransport::Get(const TransportRequest& Req)
+{
+    if (this->Sources.empty())
+        return this->Perform(Req, nullptr);
+
+    size_t index = this->Acquire();
+    Source& source = *this->Sources[index];
+    Response res = this->Perform(Req, [this, &source](CURL* Handle)
+    {
+        ApplyTuning(Handle, this->Tuning, &source.Share);
+        if (!source.Address.Interface.empty())
+            curl_easy_setopt(Handle, CURLOPT_INTERFACE, source.Address.Interface.c_str());
+        if (source.Address.LocalPort)
+        {
+            curl_easy_setopt(Handle, CURLOPT_LOCALPORT, source.Address.LocalPort);
+            curl_easy_setopt(Handle, CURLOPT_LOCALPORTRANGE, std::max(source.Address.LocalPortRange, 1L));
+        }
+    });
+    this->Release(index, res);
+    return res;
+}
+
+/*
+* @brief picks the healthy source with the fewest requests in flight, ties in rotation
+* @return index of the source, counted as in flight
+*/
+size_t RoPP::SourceTransport::Acquire()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto now = std::chrono::steady_clock::now();
+    size_t count = this->Sources.size();
+    size_t start = this->Rotation++ % count;
+
+    size_t best = count;
+    size_t fallback = start;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t index = (start + i) % count;
+        Source& source = *this->Sources[index];
+        if (source.InFlight < this->Sources[fallback]->InFlight)
+            fallback = index;
+
+        // an ejected source past its cooldown takes a single probe at a time
+        bool usable = now >= source.RestUntil && (!source.Ejected || !source.Probing);
+        if (usable && (best == count || source.InFlight < this->Sources[best]->InFlight))
+            best = index;
+    }
+    if (best == count)
+        best = fallback;
+
+    Source& chosen = *this->Sources[best];
+    if (chosen.Ejected && now >= chosen.RestUntil)
+        chosen.Probing = true;
+    chosen.InFlight++;
+    chosen.Requests++;
+    return best;
+}
+
+/*
+* @brief updates a source's health from the outcome of a request it carried
+*/
+void RoPP::SourceTransport::Release(size_t Index, const Response& Res)
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto now = std::chrono::steady_clock::now();
+    Source& source = *this->Sources[Index];
+    source.InFlight--;
+
+    if (Res.curlCode != CURLE_OK && _m_connectionFailure(Res.curlCode))
+    {
+        source.Failures++;
+        source.FailedRun++;
+        if (source.Probing || source.FailedRun >= this->Policy.FailuresToEject)
+        {
+            source.Ejected = true;
+            source.RestUntil = now + this->Policy.Cooldown;
+        }
+        source.Probing = false;
+        return;
+    }
+
+    if (Res.curlCode == CURLE_OK)
+    {
+        source.FailedRun = 0;
+        source.Ejected = false;
+        source.Probing = false;
+    }
+
+    if (Res.curlCode == CURLE_OK && Res.code == 429)
+    {
+        source.Throttled++;
+        std::chrono::seconds rest = this->Policy.ThrottleBackoff;
+        auto retry = Res.headers.find("retry-after");
+        if (retry != Res.headers.end())
+        {
+            char* end = nullptr;
+            long seconds = std::strtol(retry->second.c_str(), &end, 10);
+            if (end != retry->second.c_str() && seconds >= 0)
+                rest = std::chrono::seconds(seconds);
+        }
+        source.RestUntil = std::max(source.RestUntil, now + rest);
+    }
+}
+
+std::vector<RoPP::SourceStats> RoPP::SourceTransport::Stats()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::vector<SourceStats> stats;
+    for (auto& source : this->Sources)
+        stats.push_back({ source->Address.Interface, source->Requests, source->Failures, source->Throttled, source->InFlight, !source->Ejected });
+    return stats;
+}
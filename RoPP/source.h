@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "connection.h"
+#include "transport.h"
+
+namespace RoPP
+{
+    struct SourceAddress
+    {
+        std::string Interface;  // CURLOPT_INTERFACE: an address, "if!eth0" or "host!name"
+        long LocalPort = 0;     // first local port to bind, 0 lets the kernel choose
+        long LocalPortRange = 1;
+    };
+
+    struct SourcePolicy
+    {
+        uint32_t FailuresToEject = 3;            // connection failures in a row that take a source out
+        std::chrono::seconds Cooldown{ 10 };     // before an ejected source gets a probe request
+        std::chrono::seconds ThrottleBackoff{ 5 }; // a 429 without Retry-After rests the source this long
+    };
+
+    struct SourceStats
+    {
+        std::string Interface;
+        uint64_t Requests = 0;
+        uint64_t Failures = 0;  // connection level, HTTP errors are the server's answer
+        uint64_t Throttled = 0; // 429 responses
+        uint32_t InFlight = 0;
+        bool Healthy = true;
+    };
+
+    /*
+    * CurlTransport that spreads requests over several local source addresses, which
+    * multiplies per-ip rate limit headroom and ephemeral ports towards each host. Every
+    * source keeps its own pool of connections (a curl share handle), and each request goes
+    * to the healthy source with the fewest requests in flight.
+    *
+    * A source that fails to connect FailuresToEject times in a row is ejected for
+    * Cooldown, then gets one probe request; success brings it back. A 429 rests only the
+    * source that got it, for Retry-After. With no healthy source left, requests still go
+    * to the least loaded one rather than fail outright. Tuning applies to every source.
+    *   RoPP::SourceTransport spread({ { "10.0.0.2" }, { "10.0.0.3" }, { "10.0.0.4" } });
+    *   RoPP::SetDefaultTransport(&spread);
+    */
+    class SourceTransport : public CurlTransport
+    {
+        public:
+            SourceTransport(const std::vector<SourceAddress>& Sources, SourcePolicy Policy = {}, ConnectionTuning Tuning = {});
+            ~SourceTransport();
+
+            Response Get(const TransportRequest& Req) override;
+            std::vector<SourceStats> Stats();
+
+        private:
+            struct Source;
+
+            size_t Acquire();
+            void Release(size_t Index, const Response& Res);
+
+            const SourcePolicy Policy;
+            const ConnectionTuning Tuning;
+            std::vector<std::unique_ptr<Source>> Sources;
+            std::mutex Mutex;
+            size_t Rotation = 0;
+    };
+}
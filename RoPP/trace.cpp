@@ -0,0 +1,327 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "ring.h"
+#include "trace.h"
+
+namespace
+{
+struct _m_Buffer
+{
+    RoPP::SpscRing<RoPP::SpanRecord, 4096> Ring;
+    std::atomic<bool> Retired{ false };
+    uint32_t Thread = 0;
+};
+
+struct _m_Local
+{
+    std::shared_ptr<_m_Buffer> Buffer;
+    RoPP::TraceContext Current;
+    RoPP::Endpoint Id = RoPP::Endpoint::Unknown;
+    uint64_t Sequence = 0;
+    uint32_t Calls = 0;
+
+    ~_m_Local()
+    {
+        if (Buffer)
+            Buffer->Retired = true;
+    }
+};
+}
+
+static struct
+{
+    std::mutex Mutex;
+    std::condition_variable Wake;
+    std::thread Thread;
+    bool Stopping = false;
+    std::FILE* File = nullptr;
+    RoPP::TraceFormat Format = RoPP::TraceFormat::Chrome;
+    bool First = true;
+    int64_t EpochOffset = 0;
+    std::atomic<uint32_t> SampleEvery{ 1 };
+    std::atomic<uint64_t> Dropped{ 0 };
+
+    std::mutex RegistryMutex;
+    std::vector<std::shared_ptr<_m_Buffer>> Buffers;
+    uint32_t NextThread = 1;
+} _m_exporter;
+
+static thread_local _m_Local _m_local;
+
+static const char* _m_spanName(RoPP::SpanKind kind)
+{
+    switch (kind)
+    {
+    case RoPP::SpanKind::QueueWait: return "queue";
+    case RoPP::SpanKind::CacheLookup: return "cache";
+    case RoPP::SpanKind::Dns: return "dns";
+    case RoPP::SpanKind::Connect: return "connect";
+    case RoPP::SpanKind::Tls: return "tls";
+    case RoPP::SpanKind::Ttfb: return "ttfb";
+    case RoPP::SpanKind::Receive: return "receive";
+    case RoPP::SpanKind::Parse: return "parse";
+    default: return "call";
+    }
+}
+
+static uint64_t _m_newId()
+{
+    uint64_t x = (static_cast<uint64_t>(_m_local.Buffer ? _m_local.Buffer->Thread : 0) << 40) ^ ++_m_local.Sequence;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x ? x : 1;
+}
+
+static _m_Buffer& _m_buffer()
+{
+    if (!_m_local.Buffer)
+    {
+        auto buffer = std::make_shared<_m_Buffer>();
+        std::lock_guard<std::mutex> lock(_m_exporter.RegistryMutex);
+        buffer->Thread = _m_exporter.NextThread++;
+        _m_exporter.Buffers.push_back(buffer);
+        _m_local.Buffer = buffer;
+    }
+    return *_m_local.Buffer;
+}
+
+static void _m_write(const std::vector<RoPP::SpanRecord>& spans)
+{
+    std::FILE* file = _m_exporter.File;
+    if (spans.empty() || !file)
+        return;
+
+    if (_m_exporter.Format == RoPP::TraceFormat::Chrome)
+    {
+        int pid = getpid();
+        for (auto& span : spans)
+        {
+            const char* name = span.Kind == RoPP::SpanKind::Call ? RoPP::EndpointName(span.Id) : _m_spanName(span.Kind);
+            std::fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"ropp\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,"
+                "\"args\":{\"endpoint\":\"%s\",\"trace\":\"%016llx\",\"span\":\"%016llx\",\"parent\":\"%016llx\"}}",
+                _m_exporter.First ? "\n" : ",\n", name, span.Start / 1000.0, span.Duration / 1000.0, pid, span.Thread,
+                RoPP::EndpointName(span.Id), (unsigned long long)span.TraceId, (unsigned long long)span.SpanId, (unsigned long long)span.ParentId);
+            _m_exporter.First = false;
+        }
+    }
+    else
+    {
+        // one ExportTraceServiceRequest per line, as written by the OTLP file exporter
+        std::fputs("{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":{\"stringValue\":\"ropp\"}}]},"
+            "\"scopeSpans\":[{\"scope\":{\"name\":\"ropp\"},\"spans\":[", file);
+        for (size_t i = 0; i < spans.size(); i++)
+        {
+            auto& span = spans[i];
+            const char* name = span.Kind == RoPP::SpanKind::Call ? RoPP::EndpointName(span.Id) : _m_spanName(span.Kind);
+            unsigned long long start = span.Start + _m_exporter.EpochOffset;
+            std::fprintf(file, "%s{\"traceId\":\"%016llx%016llx\",\"spanId\":\"%016llx\",", i ? "," : "",
+                0ULL, (unsigned long long)span.TraceId, (unsigned long long)span.SpanId);
+            if (span.ParentId)
+                std::fprintf(file, "\"parentSpanId\":\"%016llx\",", (unsigned long long)span.ParentId);
+            std::fprintf(file, "\"name\":\"%s\",\"kind\":%d,\"startTimeUnixNano\":\"%llu\",\"endTimeUnixNano\":\"%llu\","
+                "\"attributes\":[{\"key\":\"ropp.endpoint\",\"value\":{\"stringValue\":\"%s\"}},{\"key\":\"thread.id\",\"value\":{\"intValue\":\"%u\"}}]}",
+                name, span.Kind == RoPP::SpanKind::Call ? 3 : 1, start, start + (unsigned long long)span.Duration, RoPP::EndpointName(span.Id), span.Thread);
+        }
+        std::fputs("]}]}]}\n", file);
+    }
+    std::fflush(file);
+}
+
+static void _m_drain()
+{
+    std::vector<std::shared_ptr<_m_Buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_m_exporter.RegistryMutex);
+        buffers = _m_exporter.Buffers;
+    }
+
+    std::vector<RoPP::SpanRecord> spans;
+    RoPP::SpanRecord span;
+    for (auto& buffer : buffers)
+        while (buffer->Ring.TryPop(span))
+            spans.push_back(span);
+    _m_write(spans);
+
+    std::lock_guard<std::mutex> lock(_m_exporter.RegistryMutex);
+    auto& all = _m_exporter.Buffers;
+    for (size_t i = 0; i < all.size();)
+    {
+        if (all[i]->Retired && all[i]->Ring.Empty())
+        {
+            all[i] = all.back();
+            all.pop_back();
+        }
+        else
+            i++;
+    }
+}
+
+/*
+* @brief starts exporting sampled spans to a file from a background thread, stopped at exit
+* when Stop was not called
+* @param Format Chrome trace events (chrome://tracing, Perfetto) or OTLP-JSON lines
+* @param SampleEvery trace one call out of this many per thread
+*/
+void RoPP::Tracer::Start(const std::string& Path, TraceFormat Format, uint32_t SampleEvery)
+{
+    Stop();
+
+    std::lock_guard<std::mutex> lock(_m_exporter.Mutex);
+    _m_exporter.File = std::fopen(Path.c_str(), "w");
+    if (!_m_exporter.File)
+        throw std::runtime_error("cannot open trace file " + Path);
+
+    auto system = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    _m_exporter.EpochOffset = system - static_cast<int64_t>(Now());
+    _m_exporter.Format = Format;
+    _m_exporter.First = true;
+    _m_exporter.Stopping = false;
+    _m_exporter.SampleEvery = SampleEvery ? SampleEvery : 1;
+    if (Format == TraceFormat::Chrome)
+        std::fputs("[", _m_exporter.File);
+
+    _m_exporter.Thread = std::thread([]
+    {
+        std::unique_lock<std::mutex> lock(_m_exporter.Mutex);
+        while (!_m_exporter.Stopping)
+        {
+            _m_exporter.Wake.wait_for(lock, std::chrono::milliseconds(200));
+            _m_drain();
+        }
+    });
+    Running = true;
+    // _m_exporter is destroyed after atexit handlers registered here run, so its thread is joined by then
+    static std::once_flag registered;
+    std::call_once(registered, [] { std::atexit(Stop); });
+}
+
+/*
+* @brief stops sampling, flushes every buffered span and closes the trace file
+*/
+void RoPP::Tracer::Stop()
+{
+    Running = false;
+    {
+        std::lock_guard<std::mutex> lock(_m_exporter.Mutex);
+        _m_exporter.Stopping = true;
+    }
+    _m_exporter.Wake.notify_all();
+    if (_m_exporter.Thread.joinable())
+        _m_exporter.Thread.join();
+
+    std::lock_guard<std::mutex> lock(_m_exporter.Mutex);
+    if (!_m_exporter.File)
+        return;
+
+    _m_drain();
+    if (_m_exporter.Format == TraceFormat::Chrome)
+        std::fputs("\n]\n", _m_exporter.File);
+    std::fclose(_m_exporter.File);
+    _m_exporter.File = nullptr;
+}
+
+/*
+* @brief gets the number of spans lost because a thread's ring was full
+* @return dropped span count
+*/
+uint64_t RoPP::Tracer::Dropped()
+{
+    return _m_exporter.Dropped;
+}
+
+RoPP::TraceContext RoPP::Tracer::Current()
+{
+    return _m_local.Current;
+}
+
+uint64_t RoPP::Tracer::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+* @brief records a finished child span of Parent into the calling thread's ring
+*/
+void RoPP::Tracer::Record(const TraceContext& Parent, SpanKind Kind, Endpoint Id, uint64_t Start, uint64_t Duration)
+{
+    if (!Parent.TraceId)
+        return;
+
+    _m_Buffer& buffer = _m_buffer();
+    SpanRecord span{ Parent.TraceId, _m_newId(), Parent.SpanId, Start, Duration, Kind, Id, buffer.Thread };
+    if (!buffer.Ring.TryPush(span))
+        _m_exporter.Dropped++;
+}
+
+/*
+* @brief records the dns, connect, tls, ttfb and receive phases of a finished transfer
+* @param Start steady clock time the transfer was started at
+*/
+void RoPP::Tracer::RecordTransfer(const TraceContext& Parent, Endpoint Id, uint64_t Start, const timings_t& Timings)
+{
+    if (!Parent.TraceId)
+        return;
+
+    auto phase = [&](SpanKind kind, curl_off_t from, curl_off_t to)
+    {
+        if (to > from)
+            Record(Parent, kind, Id, Start + from * 1000, (to - from) * 1000);
+    };
+    phase(SpanKind::Dns, 0, Timings.nameLookup);
+    phase(SpanKind::Connect, Timings.nameLookup, Timings.connect);
+    if (Timings.appConnect)
+        phase(SpanKind::Tls, Timings.connect, Timings.appConnect);
+    phase(SpanKind::Ttfb, Timings.preTransfer, Timings.startTransfer);
+    phase(SpanKind::Receive, Timings.startTransfer, Timings.total);
+}
+
+RoPP::TraceCall::TraceCall(Endpoint Id) : Id(Id)
+{
+    if (!Tracer::Enabled() || _m_local.Current.TraceId)
+        return;
+    if (_m_local.Calls++ % _m_exporter.SampleEvery.load(std::memory_order_relaxed) != 0)
+        return;
+
+    this->Active = true;
+    this->Saved = _m_local.Current;
+    this->Context.TraceId = _m_newId();
+    this->Context.SpanId = _m_newId();
+    this->Begin = Tracer::Now();
+    _m_local.Current = this->Context;
+    _m_local.Id = Id;
+}
+
+RoPP::TraceCall::~TraceCall()
+{
+    if (!this->Active)
+        return;
+
+    _m_local.Current = this->Saved;
+    _m_Buffer& buffer = _m_buffer();
+    SpanRecord span{ this->Context.TraceId, this->Context.SpanId, 0, this->Begin, Tracer::Now() - this->Begin, SpanKind::Call, this->Id, buffer.Thread };
+    if (!buffer.Ring.TryPush(span))
+        _m_exporter.Dropped++;
+}
+
+RoPP::TraceSpan::TraceSpan(SpanKind Kind) : Parent(_m_local.Current), Kind(Kind)
+{
+    if (this->Parent.TraceId)
+        this->Begin = Tracer::Now();
+}
+
+RoPP::TraceSpan::~TraceSpan()
+{
+    if (this->Parent.TraceId)
+        Tracer::Record(this->Parent, this->Kind, _m_local.Id, this->Begin, Tracer::Now() - this->Begin);
+}
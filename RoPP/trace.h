@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "../include/request.hpp"
+#include "endpoint.h"
+
+namespace RoPP
+{
+    enum class SpanKind : uint8_t { Call, QueueWait, CacheLookup, Dns, Connect, Tls, Ttfb, Receive, Parse };
+    enum class TraceFormat { Chrome, Otlp };
+
+    struct TraceContext
+    {
+        uint64_t TraceId = 0;
+        uint64_t SpanId = 0;
+    };
+
+    struct SpanRecord
+    {
+        uint64_t TraceId;
+        uint64_t SpanId;
+        uint64_t ParentId;
+        uint64_t Start;
+        uint64_t Duration;
+        SpanKind Kind;
+        Endpoint Id;
+        uint32_t Thread;
+    };
+
+    class Tracer
+    {
+        public:
+            static void Start(const std::string& Path, TraceFormat Format = TraceFormat::Chrome, uint32_t SampleEvery = 1);
+            static void Stop();
+            static uint64_t Dropped();
+
+            static bool Enabled() { return Running.load(std::memory_order_relaxed); }
+            static TraceContext Current();
+            static uint64_t Now();
+            static void Record(const TraceContext& Parent, SpanKind Kind, Endpoint Id, uint64_t Start, uint64_t Duration);
+            static void RecordTransfer(const TraceContext& Parent, Endpoint Id, uint64_t Start, const timings_t& Timings);
+
+        private:
+            friend class TraceCall;
+            static inline std::atomic<bool> Running{ false };
+    };
+
+    // root span of one RoPP call; subject to sampling, a no-op when nested in another call
+    class TraceCall
+    {
+        public:
+            explicit TraceCall(Endpoint Id);
+            ~TraceCall();
+
+        private:
+            TraceContext Saved;
+            TraceContext Context;
+            uint64_t Begin = 0;
+            Endpoint Id;
+            bool Active = false;
+    };
+
+    // child span of the current call, a no-op when the call is not sampled
+    class TraceSpan
+    {
+        public:
+            explicit TraceSpan(SpanKind Kind);
+            ~TraceSpan();
+
+        private:
+            TraceContext Parent;
+            uint64_t Begin = 0;
+            SpanKind Kind;
+    };
+}
@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "alloc.h"
+#include "log.h"
+#include "probes.h"
+#include "shaper.h"
+#include "transport.h"
+
+namespace
+{
+    struct _m_Shaping
+    {
+        RoPP::BandwidthShaper* Shaper;
+        RoPP::TrafficClass Class;
+        curl_off_t Seen;
+    };
+}
+
+// progress callback, runs between socket reads so sleeping in it stops the transfer draining its socket
+static int _m_shape(void* Data, curl_off_t, curl_off_t Received, curl_off_t, curl_off_t)
+{
+    _m_Shaping* shaping = static_cast<_m_Shaping*>(Data);
+    if (Received > shaping->Seen)
+    {
+        shaping->Shaper->Consume(shaping->Class, static_cast<uint64_t>(Received - shaping->Seen));
+        shaping->Seen = Received;
+    }
+    return 0;
+}
+
+/*
+* @brief performs a blocking GET through a fresh curl handle
+* @return the response of the request
+*/
+Response RoPP::CurlTransport::Get(const TransportRequest& Req)
+{
+    return this->Perform(Req, nullptr);
+}
+
+/*
+* @brief performs a blocking GET, letting a subclass set its own options on the handle first
+* @param Configure called with the handle before the transfer, may be empty
+* @return the response of the request
+*/
+Response RoPP::CurlTransport::Perform(const TransportRequest& Req, const std::function<void(CURL*)>& Configure)
+{
+    ROPP_ALLOC_SCOPE(Transport);
+    Request req(Req.Url);
+    for (auto& [key, value] : Req.Headers)
+        req.set_header(key, value);
+    req.initalize();
+
+    _m_Shaping shaping{ CurrentBandwidthShaper(), Req.Class, 0 };
+    if (shaping.Shaper)
+    {
+        curl_easy_setopt(req.get_handle(), CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(req.get_handle(), CURLOPT_XFERINFOFUNCTION, _m_shape);
+        curl_easy_setopt(req.get_handle(), CURLOPT_XFERINFODATA, &shaping);
+        if (uint64_t cap = shaping.Shaper->TransferCap(Req.Class))
+            curl_easy_setopt(req.get_handle(), CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(cap));
+    }
+    if (Configure)
+        Configure(req.get_handle());
+
+    ROPP_LOG(LogLevel::Debug, LogEvent::RequestStart, Req.Id, 0, 0, 0);
+    if (ROPP_PROBE_ENABLED(request_start))
+        ROPP_PROBE(request_start, Req.Id, 0, 0);
+
+    uint64_t start = Tracer::Now();
+    Response res = req.get();
+    Tracer::RecordTransfer(Req.Trace, Req.Id, start, res.timings);
+    if (Req.Profile)
+        Req.Profile->AddTransfer(res.timings, res.data.size());
+
+    if (res.curlCode != CURLE_OK)
+        ROPP_LOG(LogLevel::Warn, LogEvent::RequestFailed, Req.Id, res.curlCode, 0, res.timings.total * 1000);
+    else
+        ROPP_LOG(LogLevel::Info, LogEvent::RequestDone, Req.Id, res.code, res.data.size(), res.timings.total * 1000);
+
+    if (ROPP_PROBE_ENABLED(connect_done))
+        ROPP_PROBE(connect_done, Req.Id, 0, res.timings.connect * 1000);
+    if (ROPP_PROBE_ENABLED(first_byte))
+        ROPP_PROBE(first_byte, Req.Id, 0, res.timings.startTransfer * 1000);
+    if (ROPP_PROBE_ENABLED(request_done))
+        ROPP_PROBE(request_done, Req.Id, res.data.size(), res.timings.total * 1000);
+
+    return res;
+}
+
+static std::atomic<RoPP::Transport*> _m_override{ nullptr };
+
+/*
+* @brief gets the process wide transport used by the RoPP modules
+* @return the default transport
+*/
+RoPP::Transport& RoPP::DefaultTransport()
+{
+    static CurlTransport transport;
+    Transport* override = _m_override.load(std::memory_order_acquire);
+    return override ? *override : transport;
+}
+
+/*
+* @brief routes every RoPP module through another transport, nullptr restores the curl transport
+* @param Override must outlive its use as the default
+*/
+void RoPP::SetDefaultTransport(Transport* Override)
+{
+    _m_override.store(Override, std::memory_order_release);
+}
+
+RoPP::AsyncTransport::AsyncTransport(Transport& Inner, size_t Workers, QueuePolicy Policy)
+    : Inner(Inner), Policy(Policy), BulkLimit(std::max<size_t>(Workers - std::min(Workers, Policy.InteractiveWorkers), 1))
+{
+    for (size_t i = 0; i < Workers; i++)
+        this->Workers.emplace_back(&AsyncTransport::Work, this);
+}
+
+RoPP::AsyncTransport::~AsyncTransport()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        this->Stopping = true;
+    }
+    this->Ready.notify_all();
+    for (auto& worker : this->Workers)
+        worker.join();
+}
+
+/*
+* @brief queues a request, joining an identical request already in flight (single-flight by url)
+* @param Done called from a worker thread once the response is available
+*/
+void RoPP::AsyncTransport::Submit(const TransportRequest& Req, Callback Done)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        auto flight = this->InFlight.find(Req.Url);
+        if (flight != this->InFlight.end())
+        {
+            flight->second.push_back(std::move(Done));
+            if (Req.Class == TrafficClass::Interactive)
+                this->Promote(Req.Url);
+            return;
+        }
+
+        this->InFlight[Req.Url].push_back(std::move(Done));
+        Job job{ Req, Tracer::Now() };
+        if (!job.Req.Trace.TraceId)
+            job.Req.Trace = Tracer::Current();
+        if (!job.Req.Profile)
+            job.Req.Profile = ProfileScope::Active();
+        if (job.Req.Class == TrafficClass::Bulk)
+            this->PendingBulk.push_back(std::move(job));
+        else
+            this->Pending.push_back(std::move(job));
+    }
+    this->Ready.notify_one();
+}
+
+/*
+* @brief moves a queued bulk job an interactive caller has joined into the interactive queue, call locked
+*/
+void RoPP::AsyncTransport::Promote(const std::string& Url)
+{
+    auto bulk = std::find_if(this->PendingBulk.begin(), this->PendingBulk.end(), [&](const Job& job) { return job.Req.Url == Url; });
+    if (bulk == this->PendingBulk.end())
+        return;
+
+    Job job = std::move(*bulk);
+    this->PendingBulk.erase(bulk);
+    job.Req.Class = TrafficClass::Interactive;
+    auto at = std::upper_bound(this->Pending.begin(), this->Pending.end(), job.Enqueued, [](uint64_t enqueued, const Job& other) { return enqueued < other.Enqueued; });
+    this->Pending.insert(at, std::move(job));
+}
+
+/*
+* @brief queues a request, joining an identical request already in flight (single-flight by url)
+* @return future resolved with the response
+*/
+std::future<Response> RoPP::AsyncTransport::Submit(const TransportRequest& Req)
+{
+    auto promise = std::make_shared<std::promise<Response>>();
+    std::future<Response> future = promise->get_future();
+    this->Submit(Req, [promise](const Response& res) { promise->set_value(res); });
+
+    return future;
+}
+
+/*
+* @brief gets the queue depth and how many requests were served or shed
+*/
+RoPP::QueueStats RoPP::AsyncTransport::Stats()
+{
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    return { this->Pending.size() + this->PendingBulk.size(), this->Served, this->Dropped, this->Dropping };
+}
+
+/*
+* @brief tracks whether the queue is standing: entered once every job leaving it waited longer
+* than target for a whole interval, left as soon as one waited less or the queue drains
+* @param Head the job about to leave the queue
+*/
+bool RoPP::AsyncTransport::Standing(const Job& Head, uint64_t Now)
+{
+    uint64_t target = std::chrono::duration_cast<std::chrono::nanoseconds>(this->Policy.Target).count();
+    uint64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(this->Policy.Interval).count();
+
+    if (this->Pending.size() + this->PendingBulk.size() <= 1)
+    {
+        this->FirstAbove = 0;
+        return false;
+    }
+    if (Now - Head.Enqueued < target)
+    {
+        this->FirstAbove = 0;
+        return false;
+    }
+    if (this->Dropping)
+        return true;
+    if (!this->FirstAbove)
+    {
+        this->FirstAbove = Now + interval;
+        return false;
+    }
+    return Now >= this->FirstAbove;
+}
+
+/*
+* @brief checks whether a worker could take a job now, call locked
+*/
+bool RoPP::AsyncTransport::Runnable() const
+{
+    return !this->Pending.empty() || (!this->PendingBulk.empty() && this->BulkRunning < this->BulkLimit);
+}
+
+/*
+* @brief takes the oldest queued job after shedding expired bulk jobs, call locked; bulk jobs
+* are passed over while BulkLimit of them are running
+* @param Dropped receives the shed jobs and their waiters, to be failed outside the lock; the
+*        urls are already out of flight, so a caller submitting one again gets a new request
+* @return false when shedding left nothing to run
+*/
+bool RoPP::AsyncTransport::Next(Job& Out, std::vector<Shed>& Dropped)
+{
+    auto oldest = [this]() -> std::deque<Job>&
+    {
+        if (this->PendingBulk.empty())
+            return this->Pending;
+        if (this->Pending.empty())
+            return this->PendingBulk;
+        return this->PendingBulk.front().Enqueued < this->Pending.front().Enqueued ? this->PendingBulk : this->Pending;
+    };
+
+    if (this->Policy.Enabled && (!this->Pending.empty() || !this->PendingBulk.empty()))
+    {
+        uint64_t now = Tracer::Now();
+        this->Dropping = this->Standing(oldest().front(), now);
+
+        // while the queue stands bulk jobs may wait Target, otherwise a whole Interval
+        auto limit = this->Dropping ? this->Policy.Target : this->Policy.Interval;
+        uint64_t deadline = std::chrono::duration_cast<std::chrono::nanoseconds>(limit).count();
+        while (!this->PendingBulk.empty() && now - this->PendingBulk.front().Enqueued > deadline)
+        {
+            auto flight = this->InFlight.find(this->PendingBulk.front().Req.Url);
+            Dropped.push_back({ std::move(this->PendingBulk.front()), std::move(flight->second) });
+            this->InFlight.erase(flight);
+            this->PendingBulk.pop_front();
+            this->Dropped++;
+        }
+    }
+
+    if (!this->Runnable())
+        return false;
+    std::deque<Job>& queue = this->BulkRunning < this->BulkLimit ? oldest() : this->Pending;
+    Out = std::move(queue.front());
+    queue.pop_front();
+    if (Out.Req.Class == TrafficClass::Bulk)
+        this->BulkRunning++;
+    this->Served++;
+    return true;
+}
+
+/*
+* @brief hands a response to every caller waiting on the url
+*/
+void RoPP::AsyncTransport::Finish(const std::string& Url, const Response& Res)
+{
+    std::vector<Callback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(this->Mutex);
+        auto flight = this->InFlight.find(Url);
+        waiters = std::move(flight->second);
+        this->InFlight.erase(flight);
+    }
+
+    for (auto& done : waiters)
+        done(Res);
+}
+
+void RoPP::AsyncTransport::Work()
+{
+    for (;;)
+    {
+        Job job;
+        std::vector<Shed> dropped;
+        bool ready;
+        {
+            std::unique_lock<std::mutex> lock(this->Mutex);
+            // on shutdown workers still drain the queue, bulk jobs only as bulk workers free up
+            this->Ready.wait(lock, [this] { return this->Runnable() || (this->Stopping && this->Pending.empty() && this->PendingBulk.empty()); });
+            if (!this->Runnable())
+                return;
+
+            ready = this->Next(job, dropped);
+        }
+
+        for (Shed& entry : dropped)
+        {
+            Job& shed = entry.Dropped;
+            uint64_t queued = Tracer::Now() - shed.Enqueued;
+            Tracer::Record(shed.Req.Trace, SpanKind::QueueWait, shed.Req.Id, shed.Enqueued, queued);
+            if (shed.Req.Profile)
+                shed.Req.Profile->Queued += queued;
+            ROPP_LOG(LogLevel::Warn, LogEvent::QueueDrop, shed.Req.Id, 0, 0, queued);
+
+            Response res{};
+            res.curlCode = CURLE_OPERATION_TIMEDOUT;
+            res.message = "shed by queue management";
+            for (auto& done : entry.Waiters)
+                done(res);
+        }
+        if (!ready)
+            continue;
+
+        TransportRequest& req = job.Req;
+        uint64_t queued = Tracer::Now() - job.Enqueued;
+        Tracer::Record(req.Trace, SpanKind::QueueWait, req.Id, job.Enqueued, queued);
+        if (req.Profile)
+            req.Profile->Queued += queued;
+        Response res = this->Inner.Get(req);
+        if (req.Class == TrafficClass::Bulk)
+        {
+            bool stopping;
+            {
+                std::lock_guard<std::mutex> lock(this->Mutex);
+                this->BulkRunning--;
+                stopping = this->Stopping;
+            }
+            if (stopping)
+                this->Ready.notify_all();
+            else
+                this->Ready.notify_one();
+        }
+        this->Finish(req.Url, res);
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/request.hpp"
+#include "endpoint.h"
+#include "profile.h"
+#include "trace.h"
+
+namespace RoPP
+{
+    // bulk requests may be shed by AsyncTransport when its queue stands, interactive never are
+    enum class TrafficClass : uint8_t { Interactive, Bulk };
+
+    struct TransportRequest
+    {
+        TransportRequest(std::string Url = "", headers_t Headers = {}, Endpoint Id = Endpoint::Unknown, TraceContext Trace = {},
+            CallProfile* Profile = nullptr, TrafficClass Class = TrafficClass::Interactive)
+            : Url(std::move(Url)), Headers(std::move(Headers)), Id(Id), Trace(Trace), Profile(Profile), Class(Class)
+        {
+        }
+
+        std::string Url;
+        headers_t Headers;
+        Endpoint Id = Endpoint::Unknown;
+        TraceContext Trace;
+        CallProfile* Profile = nullptr;
+        TrafficClass Class = TrafficClass::Interactive;
+    };
+
+    class Transport
+    {
+        public:
+            virtual ~Transport() = default;
+            virtual Response Get(const TransportRequest& Req) = 0;
+    };
+
+    class CurlTransport : public Transport
+    {
+        public:
+            Response Get(const TransportRequest& Req) override;
+
+        protected:
+            Response Perform(const TransportRequest& Req, const std::function<void(CURL*)>& Configure);
+    };
+
+    Transport& DefaultTransport();
+    void SetDefaultTransport(Transport* Override);
+
+    /*
+    * Controlled delay (CoDel) management of the AsyncTransport queue, in the form used for
+    * RPC queues whose callers do not back off on drops. The queue counts as standing once
+    * every job leaving it has waited longer than Target for a whole Interval, and stops as
+    * soon as one leaves within Target. While it stands, bulk jobs queued longer than Target
+    * are failed fast, oldest first. Otherwise they are allowed a whole Interval, so a burst
+    * is still absorbed. Interactive jobs are never shed.
+    * InteractiveWorkers are kept from bulk jobs, so bulk transfers held back by a
+    * BandwidthShaper cannot occupy every worker; at least one worker always takes bulk.
+    */
+    struct QueuePolicy
+    {
+        bool Enabled = true;
+        std::chrono::milliseconds Target{ 50 };
+        std::chrono::milliseconds Interval{ 500 };
+        size_t InteractiveWorkers = 1;
+    };
+
+    struct QueueStats
+    {
+        size_t Pending = 0;
+        uint64_t Served = 0;
+        uint64_t Dropped = 0;
+        bool Dropping = false;
+    };
+
+    class AsyncTransport
+    {
+        public:
+            using Callback = std::function<void(const Response&)>;
+
+            AsyncTransport(Transport& Inner, size_t Workers = 8, QueuePolicy Policy = QueuePolicy());
+            ~AsyncTransport();
+
+            void Submit(const TransportRequest& Req, Callback Done);
+            std::future<Response> Submit(const TransportRequest& Req);
+            QueueStats Stats();
+
+        private:
+            struct Job
+            {
+                TransportRequest Req;
+                uint64_t Enqueued = 0;
+            };
+
+            // a job failed by queue management, with the callers that were waiting on it
+            struct Shed
+            {
+                Job Dropped;
+                std::vector<Callback> Waiters;
+            };
+
+            void Work();
+            bool Next(Job& Out, std::vector<Shed>& Dropped);
+            bool Runnable() const;
+            bool Standing(const Job& Head, uint64_t Now);
+            void Finish(const std::string& Url, const Response& Res);
+            void Promote(const std::string& Url);
+
+            Transport& Inner;
+            QueuePolicy Policy;
+            size_t BulkLimit;
+            size_t BulkRunning = 0;
+            std::mutex Mutex;
+            std::condition_variable Ready;
+            std::deque<Job> Pending;
+            std::deque<Job> PendingBulk;
+            uint64_t FirstAbove = 0;
+            bool Dropping = false;
+            uint64_t Served = 0;
+            uint64_t Dropped = 0;
+            std::unordered_map<std::string, std::vector<Callback>> InFlight;
+            std::vector<std::thread> Workers;
+            bool Stopping = false;
+    };
+}
@@ -1,7 +1,7 @@
 #include <string>
 
+#include "json.h"
 #include "ropp.h"
-#include "../include/request.hpp"
 
 /*
 * @brief gets the friends of the user
@@ -9,12 +9,24 @@
 */
 json RoPP::User::GetFriends(string Sort)
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/friends?userSort=" + Sort);
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/friends?userSort=" + Sort, this->CacheLayer, Endpoint::Friends);
+}
 
-    return json::parse(res.data);
+/*
+* @brief gets the ids of the user's friends as a sorted set for local lookups
+* @return friend list, empty when the friends response has no data
+*/
+RoPP::FriendList RoPP::User::GetFriendList()
+{
+    json friends = this->GetFriends();
+    std::vector<long> ids;
+    if (friends.is_object() && friends.contains("data") && friends["data"].is_array())
+    {
+        ids.reserve(friends["data"].size());
+        for (const json& user : friends["data"])
+            ids.push_back(user.value("id", 0L));
+    }
+    return FriendList(std::move(ids));
 }
 
 /*
@@ -23,12 +35,7 @@ json RoPP::User::GetFriends(string Sort)
 */
 json RoPP::User::GetFollowers(string Sort, int Limit)
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followers?sortOrder=" + Sort + "&limit=" + std::to_string(Limit));
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data);
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followers?sortOrder=" + Sort + "&limit=" + std::to_string(Limit), this->CacheLayer, Endpoint::Followers);
 }
 
 /*
@@ -37,12 +44,7 @@ json RoPP::User::GetFollowers(string Sort, int Limit)
 */
 json RoPP::User::GetFollowings(string Sort, int Limit)
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followings?sortOrder=" + Sort + "&limit=" + std::to_string(Limit));
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data);
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followings?sortOrder=" + Sort + "&limit=" + std::to_string(Limit), this->CacheLayer, Endpoint::Followings);
 }
 
 /*
@@ -51,12 +53,7 @@ json RoPP::User::GetFollowings(string Sort, int Limit)
 */
 int RoPP::User::GetFriendsCount()
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/friends/count");
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data)["count"];
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/friends/count", this->CacheLayer, Endpoint::FriendsCount)["count"];
 }
 
 /*
@@ -65,12 +62,7 @@ int RoPP::User::GetFriendsCount()
 */
 int RoPP::User::GetFollowersCount()
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followers/count");
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data)["count"];
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followers/count", this->CacheLayer, Endpoint::FollowersCount)["count"];
 }
 
 /*
@@ -79,12 +71,7 @@ int RoPP::User::GetFollowersCount()
 */
 int RoPP::User::GetFollowingsCount()
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followings/count");
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data)["count"];
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/followings/count", this->CacheLayer, Endpoint::FollowingsCount)["count"];
 }
 
 /*
@@ -93,12 +80,7 @@ int RoPP::User::GetFollowingsCount()
 */
 json RoPP::User::GetFriendsOnline()
 {
-    Request req("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/friends/online");
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data);
+    return FetchJson("https://friends.roblox.com/v1/users/" + std::to_string(this->UID) + "/friends/online", this->CacheLayer, Endpoint::FriendsOnline);
 }
 
 /*
@@ -107,12 +89,7 @@ json RoPP::User::GetFriendsOnline()
 */
 std::string RoPP::User::GetUsername()
 {
-    Request req("https://users.roblox.com/v1/users/" + std::to_string(this->UID));
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data)["name"];
+    return FetchJson("https://users.roblox.com/v1/users/" + std::to_string(this->UID), this->CacheLayer, Endpoint::UserInfo)["name"];
 }
 
 /*
@@ -121,12 +98,7 @@ std::string RoPP::User::GetUsername()
 */
 std::string RoPP::User::GetDisplayName()
 {
-    Request req("https://users.roblox.com/v1/users/" + std::to_string(this->UID));
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data)["displayName"];
+    return FetchJson("https://users.roblox.com/v1/users/" + std::to_string(this->UID), this->CacheLayer, Endpoint::UserInfo)["displayName"];
 }
 
 /*
@@ -135,12 +107,7 @@ std::string RoPP::User::GetDisplayName()
 */
 std::string RoPP::User::GetDescription()
 {
-    Request req("https://users.roblox.com/v1/users/" + std::to_string(this->UID));
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data)["description"];
+    return FetchJson("https://users.roblox.com/v1/users/" + std::to_string(this->UID), this->CacheLayer, Endpoint::UserInfo)["description"];
 }
 
 /*
@@ -149,12 +116,7 @@ std::string RoPP::User::GetDescription()
 */
 json RoPP::User::GetGroups()
 {
-    Request req("https://groups.roblox.com/v1/users/" + std::to_string(this->UID) + "/groups/roles");
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
-
-    return json::parse(res.data);
+    return FetchJson("https://groups.roblox.com/v1/users/" + std::to_string(this->UID) + "/groups/roles", this->CacheLayer, Endpoint::Groups);
 }
 
 /*
@@ -163,18 +125,23 @@ json RoPP::User::GetGroups()
 */
 int RoPP::User::GetGroupsCount()
 {
-    Request req("https://groups.roblox.com/v1/users/" + std::to_string(this->UID) + "/groups/roles");
-    req.set_header("Referer", "https://www.roblox.com/");
-    req.initalize();
-    Response res = req.get();
+    std::string data = Fetch("https://groups.roblox.com/v1/users/" + std::to_string(this->UID) + "/groups/roles", this->CacheLayer, Endpoint::Groups);
 
     //Count the number of groups by counting the occurences of "group" in the string
     std::string word = "group";
     int count = 0;
-    for (size_t pos = res.data.find(word); pos != std::string::npos; pos = res.data.find(word, pos + word.length()))
+    for (size_t pos = data.find(word); pos != std::string::npos; pos = data.find(word, pos + word.length()))
     {
         ++count;
     }
 
     return count;
+}
+
+/*
+* @brief routes this user's requests through a cache layer, nullptr disables caching
+*/
+void RoPP::User::SetCache(Cache* CacheLayer)
+{
+    this->CacheLayer = CacheLayer;
 }
\ No newline at end of file
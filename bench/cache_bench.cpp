@@ -0,0 +1,82 @@
+/*
+* cache_bench: lookup throughput against a running ropp_cached daemon.
+* usage: cache_bench <socket path> [threads=4] [batch=32] [batches per thread=10000] [keys=10000]
+*
+* Preloads synthetic keys with Put, then every thread issues pipelined GetMany batches of
+* random preloaded keys over its own connection.
+*/
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../RoPP/cache.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <socket path> [threads] [batch] [batches per thread] [keys]" << std::endl;
+        return 1;
+    }
+
+    std::string path = argv[1];
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+    size_t batch = argc > 3 ? std::stoul(argv[3]) : 32;
+    size_t batches = argc > 4 ? std::stoul(argv[4]) : 10000;
+    size_t keys = argc > 5 ? std::stoul(argv[5]) : 10000;
+
+    std::string body(512, 'x');
+    {
+        RoPP::CacheClient loader(path, false);
+        for (size_t i = 0; i < keys; i++)
+            loader.Put("https://users.roblox.com/v1/users/" + std::to_string(i), body);
+        // round trip so every Put has been applied before timing starts
+        std::string value;
+        loader.Get("https://users.roblox.com/v1/users/0", value);
+    }
+
+    std::vector<std::thread> pool;
+    std::vector<size_t> hits(threads);
+    std::vector<double> worst(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++)
+    {
+        pool.emplace_back([&, t]
+        {
+            RoPP::CacheClient client(path, false);
+            std::mt19937_64 rng(t);
+            std::vector<std::string> batchKeys(batch);
+            for (size_t b = 0; b < batches; b++)
+            {
+                for (auto& key : batchKeys)
+                    key = "https://users.roblox.com/v1/users/" + std::to_string(rng() % keys);
+
+                auto begin = std::chrono::steady_clock::now();
+                for (auto& value : client.GetMany(batchKeys))
+                    hits[t] += value.has_value();
+                std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - begin;
+                worst[t] = std::max(worst[t], took.count());
+            }
+        });
+    }
+    for (auto& thread : pool)
+        thread.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t lookups = threads * batch * batches;
+    size_t totalHits = 0;
+    for (size_t h : hits)
+        totalHits += h;
+
+    std::cout << "lookups:        " << lookups << std::endl;
+    std::cout << "hit ratio:      " << double(totalHits) / lookups << std::endl;
+    std::cout << "lookups/s:      " << lookups / elapsed.count() << std::endl;
+    std::cout << "batches/s:      " << threads * batches / elapsed.count() << std::endl;
+    std::cout << "worst batch us: " << *std::max_element(worst.begin(), worst.end()) << std::endl;
+
+    return 0;
+}
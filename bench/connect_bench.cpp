@@ -0,0 +1,246 @@
+/*
+* connect_bench: cold vs warm connection latency against a local TLS server.
+* usage: connect_bench [requests=300] [gap_ms=2]
+*
+* An in-process OpenSSL server on 127.0.0.1 answers keep-alive HTTP/1.1 with a small
+* json body, using a throwaway P-256 certificate made at startup. The same sequential
+* requests, gap_ms apart to mimic a bursty low-volume endpoint, go through
+* TunedTransport with:
+*   cold      new connection and a full handshake every request (plain CurlTransport)
+*   resumed   new connection, TLS session ticket reused
+*   fastopen  as resumed plus TCP Fast Open, effective only when net.ipv4.tcp_fastopen
+*             allows it on both ends (3)
+*   warm      pooled connection reused, no handshake after the first request
+* and reports TCP connect, TLS handshake and total time percentiles as curl measured
+* them, plus how many handshakes the server saw resume.
+*/
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../RoPP/connection.h"
+
+using namespace std::chrono;
+
+class TlsServer
+{
+public:
+    TlsServer(const std::string& certFile)
+    {
+        make_certificate(certFile);
+
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        int queue = 64;
+        fastopen = setsockopt(listener, IPPROTO_TCP, TCP_FASTOPEN, &queue, sizeof(queue)) == 0;
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(addr);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 128) != 0
+            || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &size) != 0)
+            throw std::runtime_error("tls server cannot listen");
+        port = ntohs(addr.sin_port);
+
+        acceptor = std::thread([this] { accept_loop(); });
+    }
+
+    ~TlsServer()
+    {
+        shutdown(listener, SHUT_RDWR);
+        close(listener);
+        acceptor.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int fd : connections)
+                shutdown(fd, SHUT_RDWR);
+        }
+        for (auto& worker : workers)
+            worker.join();
+        SSL_CTX_free(context);
+    }
+
+    std::string base_url() const
+    {
+        return "https://127.0.0.1:" + std::to_string(port);
+    }
+
+    bool fastopen = false;
+    std::atomic<size_t> handshakes{ 0 };
+    std::atomic<size_t> resumed{ 0 };
+
+private:
+    int listener = -1;
+    uint16_t port = 0;
+    SSL_CTX* context = nullptr;
+    std::thread acceptor;
+    std::mutex mutex;
+    std::set<int> connections;
+    std::vector<std::thread> workers;
+
+    void make_certificate(const std::string& certFile)
+    {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* cert = X509_new();
+        ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+        X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+        X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+        X509_set_pubkey(cert, key);
+        X509_NAME* name = X509_get_subject_name(cert);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+        X509_set_issuer_name(cert, name);
+
+        X509V3_CTX ctx;
+        X509V3_set_ctx_nodb(&ctx);
+        X509V3_set_ctx(&ctx, cert, cert, nullptr, nullptr, 0);
+        for (auto [nid, value] : { std::pair<int, const char*>{ NID_subject_alt_name, "IP:127.0.0.1" }, { NID_basic_constraints, "critical,CA:TRUE" } })
+        {
+            X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &ctx, nid, value);
+            X509_add_ext(cert, ext, -1);
+            X509_EXTENSION_free(ext);
+        }
+        X509_sign(cert, key, EVP_sha256());
+
+        FILE* out = std::fopen(certFile.c_str(), "w");
+        PEM_write_X509(out, cert);
+        std::fclose(out);
+
+        context = SSL_CTX_new(TLS_server_method());
+        SSL_CTX_use_certificate(context, cert);
+        SSL_CTX_use_PrivateKey(context, key);
+        X509_free(cert);
+        EVP_PKEY_free(key);
+    }
+
+    void accept_loop()
+    {
+        for (;;)
+        {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::lock_guard<std::mutex> lock(mutex);
+            connections.insert(fd);
+            workers.emplace_back([this, fd] { serve(fd); });
+        }
+    }
+
+    void serve(int fd)
+    {
+        SSL* ssl = SSL_new(context);
+        SSL_set_fd(ssl, fd);
+        if (SSL_accept(ssl) == 1)
+        {
+            handshakes++;
+            if (SSL_session_reused(ssl))
+                resumed++;
+
+            const std::string body = "{\"count\":42}";
+            const std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: "
+                + std::to_string(body.size()) + "\r\n\r\n" + body;
+            std::string buffer;
+            char chunk[4096];
+            for (;;)
+            {
+                int n = SSL_read(ssl, chunk, sizeof(chunk));
+                if (n <= 0)
+                    break;
+                buffer.append(chunk, n);
+                size_t end;
+                while ((end = buffer.find("\r\n\r\n")) != std::string::npos)
+                {
+                    buffer.erase(0, end + 4);
+                    SSL_write(ssl, response.data(), static_cast<int>(response.size()));
+                }
+            }
+        }
+        SSL_free(ssl);
+        std::lock_guard<std::mutex> lock(mutex);
+        connections.erase(fd);
+        close(fd);
+    }
+};
+
+struct Mode
+{
+    const char* name;
+    bool reuse;
+    bool resume;
+    bool fastopen;
+};
+
+int main(int argc, char** argv)
+{
+    size_t requests = argc > 1 ? std::stoul(argv[1]) : 300;
+    long gap = argc > 2 ? std::stol(argv[2]) : 2;
+
+    std::string certFile = "/tmp/ropp_connect_bench_" + std::to_string(getpid()) + ".pem";
+    TlsServer server(certFile);
+    std::printf("%zu sequential requests %ldms apart, server fast open %s\n\n", requests, gap, server.fastopen ? "on" : "off");
+    std::printf("%-9s %20s %20s %20s %9s\n", "", "tcp connect p50/p90", "tls handshake p50/p90", "total p50/p90", "resumed");
+
+    for (const Mode& mode : { Mode{ "cold", false, false, false }, Mode{ "resumed", false, true, false },
+                              Mode{ "fastopen", false, true, true }, Mode{ "warm", true, true, false } })
+    {
+        RoPP::ConnectionTuning tuning;
+        tuning.ReuseConnections = mode.reuse;
+        tuning.ResumeSessions = mode.resume;
+        tuning.FastOpen = mode.fastopen;
+        tuning.CaBundle = certFile;
+        RoPP::TunedTransport transport(tuning);
+
+        size_t handshakes = server.handshakes, resumed = server.resumed;
+        std::vector<double> connect, handshake, total;
+        for (size_t i = 0; i < requests; i++)
+        {
+            Response res = transport.Get({ server.base_url() + "/v1/users/1/friends/count" });
+            if (res.curlCode != CURLE_OK || res.code != 200)
+            {
+                std::fprintf(stderr, "%s: request failed: %s\n", mode.name, curl_easy_strerror(res.curlCode));
+                return 1;
+            }
+            // curl reports 0 for phases a reused connection skipped
+            connect.push_back(res.timings.connect / 1000.0);
+            handshake.push_back(res.timings.appConnect ? (res.timings.appConnect - res.timings.connect) / 1000.0 : 0);
+            total.push_back(res.timings.total / 1000.0);
+            std::this_thread::sleep_for(milliseconds(gap));
+        }
+
+        auto at = [](std::vector<double>& values, double q)
+        {
+            std::sort(values.begin(), values.end());
+            return values[std::min(values.size() - 1, static_cast<size_t>(q * values.size()))];
+        };
+        auto pair = [&](std::vector<double>& values)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%7.3f/%7.3f ms", at(values, 0.5), at(values, 0.9));
+            return std::string(text);
+        };
+        std::printf("%-9s %20s %20s %20s %4zu/%-4zu\n", mode.name, pair(connect).c_str(), pair(handshake).c_str(), pair(total).c_str(),
+            server.resumed - resumed, server.handshakes - handshakes);
+    }
+
+    std::remove(certFile.c_str());
+}
@@ -0,0 +1,104 @@
+/*
+* fault_bench: tail latency of the request path under injected latency and faults.
+* usage: fault_bench [requests=2000] [threads=8] [seed=1]
+*
+* Each scenario sends the same requests for the recorded friends endpoint through
+* FaultTransport -> MockTransport -> CurlTransport. It reports latency percentiles
+* and what was injected. The faults repeat exactly for a given seed.
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../RoPP/fault.h"
+#include "mock_server.h"
+
+using namespace std::chrono;
+
+struct Scenario
+{
+    const char* name;
+    RoPP::FaultProfile profile;
+};
+
+static void run(const Scenario& scenario, RoPP::Transport& transport, size_t requests, size_t threads, uint64_t seed)
+{
+    RoPP::FaultProfile profile = scenario.profile;
+    profile.Seed = seed;
+    RoPP::FaultTransport faults(transport, profile);
+
+    std::vector<uint64_t> latencies(requests);
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> ok{ 0 };
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&]
+        {
+            for (size_t i; (i = next++) < requests;)
+            {
+                RoPP::TransportRequest req{ "https://friends.roblox.com/v1/users/" + std::to_string(i % 500) + "/friends" };
+                req.Id = RoPP::Endpoint::Friends;
+                auto begin = steady_clock::now();
+                Response res = faults.Get(req);
+                latencies[i] = duration_cast<microseconds>(steady_clock::now() - begin).count();
+                if (res.curlCode == CURLE_OK && res.code == 200)
+                    ok++;
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double q) { return latencies[std::min(requests - 1, static_cast<size_t>(q * requests))] / 1000.0; };
+    RoPP::FaultStats stats = faults.Stats();
+    std::printf("%-10s p50 %7.2f  p90 %7.2f  p99 %7.2f  p999 %7.2f  max %7.2f ms  ok %5.1f%%  |",
+        scenario.name, at(0.5), at(0.9), at(0.99), at(0.999), latencies.back() / 1000.0, 100.0 * ok / requests);
+    for (size_t i = 1; i < static_cast<size_t>(RoPP::Fault::Count); i++)
+        std::printf(" %s %llu", RoPP::FaultName(static_cast<RoPP::Fault>(i)), (unsigned long long)stats.Faults[i]);
+    std::printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    size_t requests = argc > 1 ? std::stoul(argv[1]) : 2000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : 8;
+    uint64_t seed = argc > 3 ? std::stoull(argv[3]) : 1;
+
+    MockServer server;
+    add_recorded_routes(server);
+    RoPP::CurlTransport curl;
+    MockTransport transport(server, curl);
+
+    std::vector<Scenario> scenarios(5);
+    scenarios[0].name = "clean";
+
+    scenarios[1].name = "lognormal";
+    scenarios[1].profile.Latency = RoPP::LatencyModel::LogNormal(milliseconds(2), 0.6);
+
+    scenarios[2].name = "pareto";
+    scenarios[2].profile.Latency = RoPP::LatencyModel::Pareto(milliseconds(1), 1.5);
+    scenarios[2].profile.Latency.Cap = milliseconds(250);
+
+    scenarios[3].name = "faults";
+    scenarios[3].profile.Latency = RoPP::LatencyModel::LogNormal(milliseconds(2), 0.6);
+    scenarios[3].profile.ResetRate = 0.01;
+    scenarios[3].profile.ThrottleRate = 0.01;
+    scenarios[3].profile.PartialRate = 0.01;
+    scenarios[3].profile.SlowDripRate = 0.01;
+
+    scenarios[4].name = "slow_drip";
+    scenarios[4].profile.SlowDripRate = 0.05;
+    scenarios[4].profile.DripBytes = 1024;
+    scenarios[4].profile.DripInterval = milliseconds(2);
+
+    std::printf("%zu requests, %zu threads, seed %llu\n", requests, threads, (unsigned long long)seed);
+    for (const Scenario& scenario : scenarios)
+        run(scenario, transport, requests, threads, seed);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+* json_bench: RoPP's flat object json against the std::map based nlohmann::json.
+* usage: json_bench [rounds=2000]
+*
+* parse:  the recorded response bodies parsed from text
+* lookup: every key of every object in the parsed bodies looked up again by name
+* copy:   the parsed documents copied, which is what the cache does on every hit
+* Both types dump the same text for every body, checked before timing.
+*/
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../RoPP/json.h"
+
+#ifndef ROPP_BENCH_DATA_DIR
+#define ROPP_BENCH_DATA_DIR "bench/data"
+#endif
+
+template <typename Json>
+static size_t lookup_all(const Json& value)
+{
+    size_t found = 0;
+    if (value.is_object())
+    {
+        for (auto it = value.begin(); it != value.end(); ++it)
+        {
+            found += value.find(it.key()) != value.end();
+            found += lookup_all(*it);
+        }
+    }
+    else if (value.is_array())
+    {
+        for (const Json& element : value)
+            found += lookup_all(element);
+    }
+    return found;
+}
+
+template <typename Json>
+static void run(const char* name, const std::vector<std::string>& bodies, size_t rounds)
+{
+    auto time = [&](const char* phase, auto&& work)
+    {
+        size_t checksum = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t round = 0; round < rounds; round++)
+            checksum += work();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::printf("%-9s %-7s %9.3f us/round  (checksum %zu)\n", name, phase, seconds * 1e6 / rounds, checksum);
+    };
+
+    std::vector<Json> parsed;
+    for (const std::string& body : bodies)
+        parsed.push_back(Json::parse(body));
+
+    time("parse", [&]
+    {
+        size_t size = 0;
+        for (const std::string& body : bodies)
+            size += Json::parse(body).size();
+        return size;
+    });
+    time("lookup", [&]
+    {
+        size_t found = 0;
+        for (const Json& document : parsed)
+            found += lookup_all(document);
+        return found;
+    });
+    time("copy", [&]
+    {
+        size_t size = 0;
+        for (const Json& document : parsed)
+            size += Json(document).size();
+        return size;
+    });
+}
+
+int main(int argc, char** argv)
+{
+    size_t rounds = argc > 1 ? std::stoul(argv[1]) : 2000;
+
+    std::vector<std::string> bodies;
+    for (const char* file : { "user.json", "friends.json", "friends_online.json", "followers.json", "followings.json", "count.json", "groups.json" })
+    {
+        std::ifstream in(std::string(ROPP_BENCH_DATA_DIR) + "/" + file);
+        std::stringstream body;
+        body << in.rdbuf();
+        bodies.push_back(body.str());
+        if (nlohmann::json::parse(bodies.back()).dump() != json::parse(bodies.back()).dump())
+        {
+            std::fprintf(stderr, "%s: flat json dumps differently\n", file);
+            return 1;
+        }
+    }
+
+    run<nlohmann::json>("std::map", bodies, rounds);
+    run<json>("flat", bodies, rounds);
+}
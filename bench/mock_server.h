@@ -0,0 +1,250 @@
+#pragma once
+/*
+* Local stand-in for the Roblox APIs used by the benchmarks and the PGO training run.
+* MockServer is a small keep-alive HTTP/1.1 server on 127.0.0.1; MockTransport rewrites
+* https://<host>.roblox.com/<path> to http://127.0.0.1:<port>/<host>.roblox.com/<path>
+* so RoPP's real request path (curl, header parsing, json) runs against recorded bodies.
+*/
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../RoPP/transport.h"
+
+#ifndef ROPP_BENCH_DATA_DIR
+#define ROPP_BENCH_DATA_DIR "bench/data"
+#endif
+
+class MockServer
+{
+public:
+    struct Reply
+    {
+        int status = 200;
+        std::string body;
+        std::string headers;
+    };
+
+    MockServer()
+    {
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(addr);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 512) != 0
+            || getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &size) != 0)
+            throw std::runtime_error("mock server cannot listen");
+        port = ntohs(addr.sin_port);
+
+        acceptor = std::thread([this] { accept_loop(); });
+    }
+
+    ~MockServer()
+    {
+        shutdown(listener, SHUT_RDWR);
+        close(listener);
+        acceptor.join();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        stopping = true;
+        for (int fd : connections)
+            shutdown(fd, SHUT_RDWR);
+        idle.wait(lock, [this] { return connections.empty(); });
+    }
+
+    /**
+     * @brief serve a body for a path pattern, numeric path segments match {id}
+     * @param pattern e.g. /friends.roblox.com/v1/users/{id}/friends
+     */
+    void route(const std::string& pattern, Reply reply)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        routes[pattern] = std::move(reply);
+    }
+
+    void route(const std::string& pattern, const std::string& body)
+    {
+        route(pattern, Reply{ 200, body, "" });
+    }
+
+    uint16_t get_port() const
+    {
+        return port;
+    }
+
+    std::string base_url() const
+    {
+        return "http://127.0.0.1:" + std::to_string(port);
+    }
+
+    /**
+     * @brief connections accepted so far per client address
+     */
+    std::map<std::string, size_t> peer_connections()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return peers;
+    }
+
+    static std::string pattern_of(const std::string& target)
+    {
+        std::string path = target.substr(0, target.find('?'));
+        std::string pattern;
+        std::stringstream segments(path);
+        std::string segment;
+        while (std::getline(segments, segment, '/'))
+        {
+            if (segment.empty())
+                continue;
+            bool numeric = std::all_of(segment.begin(), segment.end(), [](unsigned char c) { return std::isdigit(c); });
+            pattern += "/" + (numeric ? std::string("{id}") : segment);
+        }
+        return pattern;
+    }
+
+private:
+    int listener = -1;
+    uint16_t port = 0;
+    std::thread acceptor;
+    std::mutex mutex;
+    bool stopping = false;
+    std::map<std::string, Reply> routes;
+    std::set<int> connections;
+    std::map<std::string, size_t> peers;
+    std::condition_variable idle;
+
+    void accept_loop()
+    {
+        for (;;)
+        {
+            sockaddr_in peer{};
+            socklen_t size = sizeof(peer);
+            int fd = accept4(listener, reinterpret_cast<sockaddr*>(&peer), &size, SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            char address[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address));
+
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping)
+            {
+                close(fd);
+                return;
+            }
+            connections.insert(fd);
+            peers[address]++;
+            std::thread([this, fd] { serve(fd); }).detach();
+        }
+    }
+
+    void serve(int fd)
+    {
+        std::string buffer;
+        char chunk[8192];
+        for (;;)
+        {
+            size_t end;
+            while ((end = buffer.find("\r\n\r\n")) == std::string::npos)
+            {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    connections.erase(fd);
+                    close(fd);
+                    idle.notify_all();
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+
+            std::string head = buffer.substr(0, end);
+            buffer.erase(0, end + 4);
+
+            std::stringstream line(head.substr(0, head.find("\r\n")));
+            std::string method, target;
+            line >> method >> target;
+
+            Reply reply{ 404, "{\"errors\":[{\"code\":0,\"message\":\"NotFound\"}]}", "" };
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto found = routes.find(pattern_of(target));
+                if (found != routes.end())
+                    reply = found->second;
+            }
+
+            std::string response = "HTTP/1.1 " + std::to_string(reply.status) + (reply.status == 200 ? " OK" : " Error") + "\r\n"
+                "Content-Type: application/json; charset=utf-8\r\n"
+                "Set-Cookie: RBXEventTrackerV2=CreateDate=5/4/2023 5:16:45 PM&rbxid=&browserid=1; path=/; expires=Fri, 20 Sep 2030 22:16:45 GMT;\r\n"
+                + reply.headers +
+                "Content-Length: " + std::to_string(reply.body.size()) + "\r\n\r\n" + reply.body;
+            if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0)
+                continue;
+        }
+    }
+};
+
+/**
+ * @brief register recorded Roblox bodies for every endpoint RoPP::User calls
+ */
+inline void add_recorded_routes(MockServer& server, const std::string& directory = ROPP_BENCH_DATA_DIR)
+{
+    auto load = [&](const std::string& file)
+    {
+        std::ifstream in(directory + "/" + file);
+        if (!in)
+            throw std::runtime_error("missing recorded response " + directory + "/" + file);
+        std::stringstream body;
+        body << in.rdbuf();
+        return body.str();
+    };
+
+    server.route("/users.roblox.com/v1/users/{id}", load("user.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/friends", load("friends.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/friends/online", load("friends_online.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/followers", load("followers.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/followings", load("followings.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/friends/count", load("count.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/followers/count", load("count.json"));
+    server.route("/friends.roblox.com/v1/users/{id}/followings/count", load("count.json"));
+    server.route("/groups.roblox.com/v1/users/{id}/groups/roles", load("groups.json"));
+}
+
+class MockTransport : public RoPP::Transport
+{
+public:
+    MockTransport(const MockServer& server, RoPP::Transport& inner) : base(server.base_url()), inner(inner) {}
+
+    Response Get(const RoPP::TransportRequest& req) override
+    {
+        RoPP::TransportRequest local = req;
+        const std::string scheme = "https://";
+        if (local.Url.compare(0, scheme.size(), scheme) == 0)
+            local.Url = base + "/" + local.Url.substr(scheme.size());
+        return inner.Get(local);
+    }
+
+private:
+    std::string base;
+    RoPP::Transport& inner;
+};
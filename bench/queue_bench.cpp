@@ -0,0 +1,114 @@
+/*
+* queue_bench: AsyncTransport queueing delay under an overload burst, CoDel off and on.
+* usage: queue_bench [seconds=3] [rate per second=2400] [bulk percent=70] [workers=8] [service ms=5]
+*
+* A stub transport holds each request for a fixed service time, so capacity is
+* workers / service time. The offered load exceeds that for the whole burst. The
+* interactive share alone fits, so with CoDel the standing queue should be bulk work
+* that gets shed, while interactive latency stays near the target.
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../RoPP/transport.h"
+
+using namespace std::chrono;
+
+class ServiceTransport : public RoPP::Transport
+{
+public:
+    explicit ServiceTransport(microseconds service) : service(service) {}
+
+    Response Get(const RoPP::TransportRequest&) override
+    {
+        std::this_thread::sleep_for(service);
+        Response res{};
+        res.curlCode = CURLE_OK;
+        res.code = 200;
+        return res;
+    }
+
+private:
+    microseconds service;
+};
+
+struct Samples
+{
+    std::mutex mutex;
+    std::vector<double> interactive;
+    std::vector<double> bulk;
+    size_t shed = 0;
+};
+
+static double percentile(std::vector<double>& values, double q)
+{
+    if (values.empty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(q * values.size()))];
+}
+
+static void run(const char* name, RoPP::QueuePolicy policy, double seconds, double rate, int bulkPercent, size_t workers, microseconds service)
+{
+    ServiceTransport stub(service);
+    Samples samples;
+    auto begin = steady_clock::now();
+    size_t total = static_cast<size_t>(seconds * rate);
+    RoPP::QueueStats stats;
+    {
+        RoPP::AsyncTransport transport(stub, workers, policy);
+        for (size_t i = 0; i < total; i++)
+        {
+            std::this_thread::sleep_until(begin + duration_cast<steady_clock::duration>(duration<double>(i / rate)));
+
+            RoPP::TransportRequest req{ "https://users.roblox.com/v1/users/" + std::to_string(i) };
+            bool bulk = static_cast<int>(i * 7919 % 100) < bulkPercent;
+            req.Class = bulk ? RoPP::TrafficClass::Bulk : RoPP::TrafficClass::Interactive;
+            auto submitted = steady_clock::now();
+            transport.Submit(req, [&samples, submitted, bulk](const Response& res)
+            {
+                double ms = duration<double, std::milli>(steady_clock::now() - submitted).count();
+                std::lock_guard<std::mutex> lock(samples.mutex);
+                if (res.curlCode != CURLE_OK)
+                    samples.shed++;
+                else
+                    (bulk ? samples.bulk : samples.interactive).push_back(ms);
+            });
+        }
+        while (transport.Stats().Pending)
+            std::this_thread::sleep_for(milliseconds(1));
+        stats = transport.Stats();
+    }
+    double elapsed = duration<double>(steady_clock::now() - begin).count();
+
+    std::printf("%-6s interactive p50 %7.1f p99 %7.1f ms | bulk p50 %7.1f p99 %7.1f ms | done %5zu shed %5zu | %6.0f done/s\n",
+        name, percentile(samples.interactive, 0.5), percentile(samples.interactive, 0.99),
+        percentile(samples.bulk, 0.5), percentile(samples.bulk, 0.99),
+        samples.interactive.size() + samples.bulk.size(), samples.shed,
+        (samples.interactive.size() + samples.bulk.size()) / elapsed);
+    (void)stats;
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? std::stod(argv[1]) : 3;
+    double rate = argc > 2 ? std::stod(argv[2]) : 2400;
+    int bulkPercent = argc > 3 ? std::stoi(argv[3]) : 70;
+    size_t workers = argc > 4 ? std::stoul(argv[4]) : 8;
+    microseconds service = microseconds(static_cast<int64_t>((argc > 5 ? std::stod(argv[5]) : 5) * 1000));
+
+    std::printf("%.0f req/s for %.1f s, %d%% bulk, capacity %.0f req/s\n", rate, seconds, bulkPercent,
+        workers * 1e6 / service.count());
+
+    RoPP::QueuePolicy off;
+    off.Enabled = false;
+    run("fifo", off, seconds, rate, bulkPercent, workers, service);
+    run("codel", RoPP::QueuePolicy(), seconds, rate, bulkPercent, workers, service);
+    return 0;
+}
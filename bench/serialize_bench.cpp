@@ -0,0 +1,146 @@
+/*
+* serialize_bench: RoPP::WriteJson against building a json value and calling dump().
+* usage: serialize_bench [items=1000] [rounds=200]
+*
+* Each round writes the same synthetic results, game details with multi line
+* descriptions that need escaping, inventory items and badge awards, as one JSON array
+* per type. The dom side builds json objects with the same member names and dumps them;
+* the direct side appends into one buffer that is cleared between rounds. Both outputs
+* are parsed back and compared before timing.
+*/
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../RoPP/json.h"
+#include "../RoPP/ropp.h"
+
+static json to_dom(const RoPP::GameDetails& value)
+{
+    return { { "universeId", value.UniverseId }, { "rootPlaceId", value.RootPlaceId }, { "name", value.Name },
+        { "description", value.Description }, { "creatorId", value.CreatorId }, { "creatorName", value.CreatorName },
+        { "creatorType", value.CreatorType }, { "playing", value.Playing }, { "visits", value.Visits },
+        { "maxPlayers", value.MaxPlayers }, { "favorites", value.Favorites }, { "genre", value.Genre },
+        { "created", value.Created }, { "updated", value.Updated } };
+}
+
+static json to_dom(const RoPP::InventoryItem& value)
+{
+    return { { "assetId", value.AssetId }, { "userAssetId", value.UserAssetId }, { "name", value.Name },
+        { "assetType", value.AssetType }, { "created", value.Created } };
+}
+
+static json to_dom(const RoPP::BadgeAward& value)
+{
+    return { { "userId", value.UserId }, { "badgeId", value.BadgeId }, { "awarded", value.Awarded }, { "awardedDate", value.AwardedDate } };
+}
+
+template <typename T>
+static void dump_dom(std::string& out, const std::vector<T>& values)
+{
+    json array = json::array();
+    for (const T& value : values)
+        array.push_back(to_dom(value));
+    out += array.dump();
+}
+
+struct Results
+{
+    std::vector<RoPP::GameDetails> games;
+    std::vector<RoPP::InventoryItem> items;
+    std::vector<RoPP::BadgeAward> awards;
+};
+
+static Results make_results(size_t count)
+{
+    Results results;
+    for (size_t i = 0; i < count; i++)
+    {
+        long id = 1000000 + static_cast<long>(i) * 7919;
+        RoPP::GameDetails game;
+        game.UniverseId = id;
+        game.RootPlaceId = id * 3;
+        game.Name = "Obby Tycoon " + std::to_string(i);
+        game.Description = "Welcome to \"Obby Tycoon\"!\n\nBuild your base, beat the obby and climb the leaderboard.\n"
+            "Updates every Friday \xE2\x80\x94 join the group for 10% more coins.\tThanks for 1B visits!";
+        game.CreatorId = id / 5;
+        game.CreatorName = "Studio" + std::to_string(i % 97);
+        game.CreatorType = i % 3 ? "Group" : "User";
+        game.Playing = static_cast<long>(i * 37 % 50000);
+        game.Visits = 1234567890L + static_cast<long>(i);
+        game.MaxPlayers = 30;
+        game.Favorites = static_cast<long>(i * 11);
+        game.Genre = "Adventure";
+        game.Created = "2019-04-11T20:12:44.187Z";
+        game.Updated = "2024-09-30T17:01:05.5Z";
+        results.games.push_back(game);
+
+        results.items.push_back({ id, id * 13 + 5, "Valkyrie Helm " + std::to_string(i), "Hat", "2021-02-03T04:05:06.789Z" });
+        results.awards.push_back({ 261, id, i % 4 != 0, i % 4 ? "2022-08-14T09:30:00Z" : "" });
+    }
+    return results;
+}
+
+template <typename Write>
+static double time_rounds(size_t rounds, std::string& out, Write&& write)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++)
+    {
+        out.clear();
+        write(out);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+    Results results = make_results(count);
+
+    auto dom = [&](std::string& out)
+    {
+        dump_dom(out, results.games);
+        dump_dom(out, results.items);
+        dump_dom(out, results.awards);
+    };
+    auto direct = [&](std::string& out)
+    {
+        RoPP::WriteJson(out, results.games);
+        RoPP::WriteJson(out, results.items);
+        RoPP::WriteJson(out, results.awards);
+    };
+
+    std::string domText, directText;
+    dom(domText);
+    direct(directText);
+    // the three arrays are back to back, compare them one value at a time
+    auto split = [](const std::string& text)
+    {
+        std::vector<json> values;
+        size_t begin = 0, depth = 0;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] == '[' && depth++ == 0)
+                begin = i;
+            else if (text[i] == ']' && --depth == 0)
+                values.push_back(json::parse(text.substr(begin, i - begin + 1)));
+        }
+        return values;
+    };
+    if (split(domText) != split(directText))
+    {
+        std::fprintf(stderr, "direct output differs from dump()\n");
+        return 1;
+    }
+
+    std::string out;
+    double domSeconds = time_rounds(rounds, out, dom);
+    double directSeconds = time_rounds(rounds, out, direct);
+    double megabytes = static_cast<double>(directText.size()) * rounds / 1e6;
+    std::printf("%zu results per type, %zu bytes per round, %zu rounds\n", count, directText.size(), rounds);
+    std::printf("%-8s %8.3f s %9.1f MB/s %8.1f ns/result\n", "dump", domSeconds, megabytes / domSeconds, domSeconds * 1e9 / (rounds * count * 3));
+    std::printf("%-8s %8.3f s %9.1f MB/s %8.1f ns/result\n", "direct", directSeconds, megabytes / directSeconds, directSeconds * 1e9 / (rounds * count * 3));
+}
@@ -0,0 +1,68 @@
+/*
+* source_bench: spreading requests over local source addresses.
+* usage: source_bench [requests=4000] [threads=8]
+*
+* Loopback aliases stand in for a host's addresses: all of 127.0.0.0/8 reaches lo on
+* Linux, so 127.0.0.2-4 bind without setup. 192.0.2.1 (TEST-NET-1) is not local and
+* fails to bind, which shows a dead source being ejected. The server side counts the
+* connections it accepted per client address, so pooling shows up as a handful of
+* connections per source rather than one per request.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../RoPP/source.h"
+#include "mock_server.h"
+
+using namespace std::chrono;
+
+int main(int argc, char** argv)
+{
+    size_t requests = argc > 1 ? std::stoul(argv[1]) : 4000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : 8;
+
+    MockServer server;
+    add_recorded_routes(server);
+
+    RoPP::SourcePolicy policy;
+    policy.FailuresToEject = 2;
+    policy.Cooldown = seconds(1);
+    RoPP::SourceTransport spread({ { "127.0.0.2" }, { "127.0.0.3" }, { "127.0.0.4" }, { "192.0.2.1" } }, policy);
+    MockTransport transport(server, spread);
+
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> ok{ 0 };
+    auto begin = steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&]
+        {
+            for (size_t i; (i = next++) < requests;)
+            {
+                RoPP::TransportRequest req{ "https://friends.roblox.com/v1/users/" + std::to_string(i % 500) + "/friends/count" };
+                req.Id = RoPP::Endpoint::FriendsCount;
+                Response res = transport.Get(req);
+                if (res.curlCode == CURLE_OK && res.code == 200)
+                    ok++;
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    double elapsed = duration<double>(steady_clock::now() - begin).count();
+
+    std::printf("%zu requests, %zu ok, %.0f req/s\n\n", requests, ok.load(), requests / elapsed);
+    std::printf("%-12s %9s %9s %9s %8s\n", "source", "requests", "failures", "throttled", "healthy");
+    for (const RoPP::SourceStats& source : spread.Stats())
+        std::printf("%-12s %9lu %9lu %9lu %8s\n", source.Interface.c_str(), static_cast<unsigned long>(source.Requests),
+            static_cast<unsigned long>(source.Failures), static_cast<unsigned long>(source.Throttled), source.Healthy ? "yes" : "no");
+
+    std::printf("\nserver side connections per client address\n");
+    for (const auto& [address, connections] : server.peer_connections())
+        std::printf("%-12s %9zu\n", address.c_str(), connections);
+}
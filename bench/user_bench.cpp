@@ -0,0 +1,46 @@
+/*
+* user_bench: RoPP::User throughput against recorded responses on a local mock server.
+* usage: user_bench [users=50] [rounds=4] [parse rounds=2000]
+*
+* network: every call goes through curl to the mock, no cache
+* cached:  the same calls answered from a warm MemoryCache, so only lookup and json remain
+* parse:   RoPP::ParseJson of the recorded bodies with no transport at all
+*/
+#include <cstdio>
+#include <string>
+
+#include "../RoPP/alloc.h"
+#include "workload.h"
+
+static void print_result(const char* name, const WorkloadResult& result)
+{
+    std::printf("%-8s %8zu calls %8.3f s %10.0f calls/s  (checksum %zu)\n", name, result.calls, result.seconds,
+        result.calls / result.seconds, result.checksum);
+}
+
+int main(int argc, char** argv)
+{
+    size_t users = argc > 1 ? std::stoul(argv[1]) : 50;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 4;
+    size_t parseRounds = argc > 3 ? std::stoul(argv[3]) : 2000;
+
+    MockServer server;
+    add_recorded_routes(server);
+    RoPP::CurlTransport curl;
+    MockTransport transport(server, curl);
+    RoPP::SetDefaultTransport(&transport);
+
+    print_result("network", run_user_workload(1, users, rounds, nullptr));
+
+    RoPP::MemoryCache cache(users * 16, std::chrono::seconds(3600));
+    run_user_workload(1, users, 1, &cache);
+    print_result("cached", run_user_workload(1, users, rounds * 50, &cache));
+
+    print_result("parse", run_parse_workload(parseRounds));
+
+    RoPP::SetDefaultTransport(nullptr);
+#ifdef ROPP_ALLOC_ACCOUNTING
+    std::printf("\n%s", RoPP::AllocReport().c_str());
+#endif
+    return 0;
+}
@@ -0,0 +1,83 @@
+#pragma once
+/*
+* The User workload shared by user_bench and the PGO training run (ropp_train): every
+* RoPP::User call against recorded responses served by MockServer, with and without a
+* MemoryCache in front, plus json parsing of the recorded bodies on their own.
+*/
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../RoPP/json.h"
+#include "../RoPP/ropp.h"
+#include "mock_server.h"
+
+struct WorkloadResult
+{
+    size_t calls = 0;
+    double seconds = 0;
+    size_t checksum = 0;
+};
+
+/**
+ * @brief calls every User method for users [first, first + users), rounds times over
+ */
+inline WorkloadResult run_user_workload(long first, size_t users, size_t rounds, RoPP::Cache* cache)
+{
+    WorkloadResult result;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++)
+    {
+        for (size_t i = 0; i < users; i++)
+        {
+            RoPP::User user(first + static_cast<long>(i));
+            user.SetCache(cache);
+
+            result.checksum += user.GetUsername().size();
+            result.checksum += user.GetDisplayName().size();
+            result.checksum += user.GetDescription().size();
+            result.checksum += user.GetFriends().size();
+            result.checksum += user.GetFriendsOnline().size();
+            result.checksum += user.GetFriendsCount();
+            result.checksum += user.GetFollowers().size();
+            result.checksum += user.GetFollowersCount();
+            result.checksum += user.GetFollowings().size();
+            result.checksum += user.GetFollowingsCount();
+            result.checksum += user.GetGroups().size();
+            result.checksum += user.GetGroupsCount();
+            result.calls += 12;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+/**
+ * @brief parses every recorded body rounds times, the decode half of the request path
+ */
+inline WorkloadResult run_parse_workload(size_t rounds, const std::string& directory = ROPP_BENCH_DATA_DIR)
+{
+    std::vector<std::string> bodies;
+    for (const char* file : { "user.json", "friends.json", "friends_online.json", "followers.json", "followings.json", "count.json", "groups.json" })
+    {
+        std::ifstream in(directory + "/" + file);
+        std::stringstream body;
+        body << in.rdbuf();
+        bodies.push_back(body.str());
+    }
+
+    WorkloadResult result;
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++)
+    {
+        for (const std::string& body : bodies)
+        {
+            result.checksum += RoPP::ParseJson(body).size();
+            result.calls++;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
@@ -10,6 +10,12 @@
 #else
 #include <curl/curl.h>
 #endif
+#ifdef ROPP_ALLOC_ACCOUNTING
+#include "../RoPP/alloc.h"
+#endif
+#ifndef ROPP_ALLOC_SCOPE
+#define ROPP_ALLOC_SCOPE(tag) do {} while (0)
+#endif
 
 typedef std::map<std::string, std::string> headers_t;
 typedef headers_t cookies_t;
@@ -25,6 +31,17 @@ static size_t _m_writeFunction(void* ptr, size_t size, size_t nmemb, std::vector
     return size * nmemb;
 }
 
+// transfer phase offsets in microseconds from the start of the transfer, as reported by curl
+struct timings_t
+{
+    curl_off_t nameLookup;
+    curl_off_t connect;
+    curl_off_t appConnect;
+    curl_off_t preTransfer;
+    curl_off_t startTransfer;
+    curl_off_t total;
+};
+
 struct Response
 {
     CURLcode curlCode;
@@ -35,6 +52,7 @@ struct Response
     std::vector<uint8_t> rawHeaders;
     headers_t headers;
     cookies_t cookies;
+    timings_t timings;
 };
 
 class Request
@@ -178,6 +196,14 @@ public:
     {
         return data;
     }
+    /**
+     * @brief return the curl handle, for options the request does not wrap
+     * @return the handle, valid after initalize
+     */
+    CURL* get_handle() const
+    {
+        return curl;
+    }
 
 private:
     std::string url;
@@ -188,9 +214,6 @@ private:
 
     void prepare()
     {
-#ifdef _VERBOSE
-        curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-#endif
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         // set headers
         prepareHeaders();
@@ -233,9 +256,21 @@ private:
 
         CURLcode curlCode = curl_easy_perform(curl);
 
-        if (curlCode != CURLE_OK) return { curlCode };
+        curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &response.timings.nameLookup);
+        curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &response.timings.connect);
+        curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &response.timings.appConnect);
+        curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &response.timings.preTransfer);
+        curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &response.timings.startTransfer);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &response.timings.total);
+
+        if (curlCode != CURLE_OK)
+        {
+            response.curlCode = curlCode;
+            return response;
+        }
 
         // read into response data
+        ROPP_ALLOC_SCOPE(Headers);
         response.rawData = responseData;
         uint8_t* rawData = responseData.data();
         response.data = std::string(rawData, rawData + responseData.size());
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Builds an LTO + PGO optimised ropp in <build dir> (default build-pgo):
+#   1. configure with ROPP_PGO=GENERATE and build the instrumented library and ropp_train
+#   2. run ropp_train, which replays bench/data through the mock server
+#   3. reconfigure the same tree with ROPP_PGO=USE and rebuild
+# gcc finds each object's profile by path, so the tree is reused rather than rebuilt elsewhere.
+# usage: tools/pgo_build.sh [build dir] [extra cmake args...]
+set -e
+
+SOURCE="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD="${1:-build-pgo}"
+[ $# -gt 0 ] && shift
+PROFILES="$(mkdir -p "$BUILD" && cd "$BUILD" && pwd)/pgo"
+JOBS="$(nproc 2>/dev/null || echo 4)"
+
+rm -rf "$PROFILES"
+cmake -S "$SOURCE" -B "$BUILD" -DCMAKE_BUILD_TYPE=Release -DROPP_LTO=ON -DROPP_PGO=GENERATE -DROPP_PGO_DIR="$PROFILES" "$@"
+cmake --build "$BUILD" -j"$JOBS" --target ropp_train
+"$BUILD/ropp_train"
+
+if command -v llvm-profdata >/dev/null 2>&1 && ls "$PROFILES"/*.profraw >/dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILES/default.profdata" "$PROFILES"/*.profraw
+fi
+
+cmake -S "$SOURCE" -B "$BUILD" -DROPP_PGO=USE "$@"
+cmake --build "$BUILD" -j"$JOBS" --clean-first
@@ -0,0 +1,262 @@
+/*
+* ropp_cached: shared RoPP response cache for processes that cannot map shared memory.
+* usage: ropp_cached <socket path> [workers=8] [capacity=65536] [ttl seconds=60]
+*
+* Speaks the RoPP::CacheProtocol framing over a unix stream socket. Requests are
+* pipelined: every complete frame in a read is answered in one write, and Fetch misses
+* are resolved through an AsyncTransport so concurrent misses on one url share a request.
+*/
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../RoPP/cache.h"
+#include "../RoPP/transport.h"
+
+using namespace RoPP;
+
+struct Client
+{
+    int Fd;
+    std::string In;
+    std::string Out;
+};
+
+struct Completion
+{
+    uint64_t Client;
+    uint32_t Id;
+    std::string Key;
+    Response Res;
+};
+
+static std::atomic<bool> running{ true };
+
+static void _m_stop(int)
+{
+    running = false;
+}
+
+static bool _m_fetchable(const std::string& url)
+{
+    const std::string scheme = "https://";
+    if (url.compare(0, scheme.size(), scheme) != 0)
+        return false;
+
+    size_t hostEnd = url.find('/', scheme.size());
+    std::string host = url.substr(scheme.size(), hostEnd - scheme.size());
+    const std::string domain = ".roblox.com";
+    return host.size() > domain.size() && host.compare(host.size() - domain.size(), domain.size(), domain) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <socket path> [workers] [capacity] [ttl seconds]" << std::endl;
+        return 1;
+    }
+
+    std::string path = argv[1];
+    size_t workers = argc > 2 ? std::stoul(argv[2]) : 8;
+    size_t capacity = argc > 3 ? std::stoul(argv[3]) : 65536;
+    std::chrono::seconds ttl(argc > 4 ? std::stol(argv[4]) : 60);
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, _m_stop);
+    std::signal(SIGTERM, _m_stop);
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "socket path too long" << std::endl;
+        return 1;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    unlink(path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 128) != 0)
+    {
+        std::cerr << "cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    int wake[2];
+    if (pipe2(wake, O_NONBLOCK | O_CLOEXEC) != 0)
+        return 1;
+
+    MemoryCache store(capacity, ttl);
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+    std::map<uint64_t, Client> clients;
+    uint64_t nextClient = 1;
+
+    {
+        AsyncTransport transport(DefaultTransport(), workers);
+
+        auto handle = [&](uint64_t serial, Client& client, CacheProtocol::RequestFrame& frame)
+        {
+            std::string value;
+            switch (frame.Op)
+            {
+            case CacheProtocol::Put:
+                if (frame.Ttl)
+                    store.Put(frame.Key, frame.Value, std::chrono::seconds(frame.Ttl));
+                else
+                    store.Put(frame.Key, frame.Value);
+                return;
+            case CacheProtocol::Get:
+                if (store.Get(frame.Key, value))
+                    CacheProtocol::EncodeResponse(client.Out, CacheProtocol::Hit, frame.Id, value);
+                else
+                    CacheProtocol::EncodeResponse(client.Out, CacheProtocol::Miss, frame.Id);
+                return;
+            case CacheProtocol::Fetch:
+                if (store.Get(frame.Key, value))
+                {
+                    CacheProtocol::EncodeResponse(client.Out, CacheProtocol::Hit, frame.Id, value);
+                    return;
+                }
+                if (!_m_fetchable(frame.Key))
+                {
+                    CacheProtocol::EncodeResponse(client.Out, CacheProtocol::Error, frame.Id);
+                    return;
+                }
+                transport.Submit({ frame.Key, { { "Referer", "https://www.roblox.com/" } } },
+                    [&, serial, id = frame.Id, key = frame.Key](const Response& res)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(completionMutex);
+                            completions.push_back({ serial, id, key, res });
+                        }
+                        char byte = 0;
+                        (void)!write(wake[1], &byte, 1);
+                    });
+                return;
+            default:
+                CacheProtocol::EncodeResponse(client.Out, CacheProtocol::Error, frame.Id);
+            }
+        };
+
+        std::vector<pollfd> fds;
+        std::vector<uint64_t> serials;
+        while (running)
+        {
+            fds.clear();
+            serials.clear();
+            fds.push_back({ listener, POLLIN, 0 });
+            fds.push_back({ wake[0], POLLIN, 0 });
+            for (auto& [serial, client] : clients)
+            {
+                fds.push_back({ client.Fd, static_cast<short>(POLLIN | (client.Out.empty() ? 0 : POLLOUT)), 0 });
+                serials.push_back(serial);
+            }
+
+            if (poll(fds.data(), fds.size(), 1000) < 0)
+                continue;
+
+            if (fds[0].revents & POLLIN)
+            {
+                int fd;
+                while ((fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                    clients[nextClient++] = { fd, "", "" };
+            }
+
+            if (fds[1].revents & POLLIN)
+            {
+                char drain[256];
+                while (read(wake[0], drain, sizeof(drain)) > 0) {}
+
+                std::vector<Completion> done;
+                {
+                    std::lock_guard<std::mutex> lock(completionMutex);
+                    done.swap(completions);
+                }
+                for (auto& completion : done)
+                {
+                    bool ok = completion.Res.curlCode == CURLE_OK && completion.Res.code == 200;
+                    if (ok)
+                        store.Put(completion.Key, completion.Res.data);
+
+                    auto client = clients.find(completion.Client);
+                    if (client == clients.end())
+                        continue;
+                    if (ok)
+                        CacheProtocol::EncodeResponse(client->second.Out, CacheProtocol::Hit, completion.Id, completion.Res.data);
+                    else
+                        CacheProtocol::EncodeResponse(client->second.Out, CacheProtocol::Error, completion.Id);
+                }
+            }
+
+            for (size_t i = 0; i < serials.size(); i++)
+            {
+                Client& client = clients[serials[i]];
+                bool closed = fds[i + 2].revents & (POLLERR | POLLHUP | POLLNVAL);
+
+                if (fds[i + 2].revents & POLLIN)
+                {
+                    char chunk[65536];
+                    ssize_t n;
+                    while ((n = recv(client.Fd, chunk, sizeof(chunk), 0)) > 0)
+                        client.In.append(chunk, n);
+                    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+                        closed = true;
+
+                    try
+                    {
+                        size_t offset = 0, used;
+                        CacheProtocol::RequestFrame frame;
+                        while ((used = CacheProtocol::DecodeRequest(client.In.data() + offset, client.In.size() - offset, frame)) != 0)
+                        {
+                            handle(serials[i], client, frame);
+                            offset += used;
+                        }
+                        client.In.erase(0, offset);
+                    }
+                    catch (const std::exception&)
+                    {
+                        closed = true;
+                    }
+                }
+
+                while (!client.Out.empty())
+                {
+                    ssize_t n = send(client.Fd, client.Out.data(), client.Out.size(), MSG_NOSIGNAL);
+                    if (n <= 0)
+                    {
+                        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+                            closed = true;
+                        break;
+                    }
+                    client.Out.erase(0, n);
+                }
+
+                if (closed)
+                {
+                    close(client.Fd);
+                    clients.erase(serials[i]);
+                }
+            }
+        }
+    }
+
+    for (auto& [serial, client] : clients)
+        close(client.Fd);
+    close(listener);
+    unlink(path.c_str());
+    curl_global_cleanup();
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+/*
+* ropp_train: PGO training run for the ropp library.
+* usage: ropp_train [users=40] [rounds=3]
+*
+* Replays the recorded Roblox responses in bench/data through a local mock server and
+* drives every RoPP::User call over it, cold and cached, so the instrumented build
+* (-DROPP_PGO=GENERATE) records the request, header parsing and json paths real
+* callers take. See tools/pgo_build.sh.
+*/
+#include <iostream>
+#include <string>
+
+#include "../bench/workload.h"
+
+int main(int argc, char** argv)
+{
+    size_t users = argc > 1 ? std::stoul(argv[1]) : 40;
+    size_t rounds = argc > 2 ? std::stoul(argv[2]) : 3;
+
+    MockServer server;
+    add_recorded_routes(server);
+    RoPP::CurlTransport curl;
+    MockTransport transport(server, curl);
+    RoPP::SetDefaultTransport(&transport);
+
+    RoPP::MemoryCache cache(users * 16, std::chrono::seconds(3600));
+    WorkloadResult cold = run_user_workload(1, users, rounds, nullptr);
+    WorkloadResult cached = run_user_workload(1, users, rounds * 20, &cache);
+    WorkloadResult parse = run_parse_workload(rounds * 500);
+
+    RoPP::SetDefaultTransport(nullptr);
+    std::cout << "trained on " << cold.calls + cached.calls + parse.calls << " calls" << std::endl;
+    return 0;
+}